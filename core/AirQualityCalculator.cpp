@@ -0,0 +1,131 @@
+#include "AirQualityCalculator.h"
+#include "SeriesFrame.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//górne granice poziomów 0-4 (µg/m³, stężenia 1-godzinne), powyżej ostatniej - "Bardzo zły"
+struct Thresholds {
+    float upper[AirQualityCalculator::MaxLevel];
+};
+
+const Thresholds* thresholdsFor(const QString &paramCode) {
+    //progi indeksu jakości powietrza GIOŚ
+    static const QHash<QString, Thresholds> thresholds = {
+        {"PM10", {{20, 50, 80, 110, 150}}},
+        {"PM2.5", {{13, 35, 55, 75, 110}}},
+        {"O3", {{70, 120, 150, 180, 240}}},
+        {"NO2", {{40, 90, 120, 230, 400}}},
+        {"SO2", {{50, 100, 200, 350, 500}}}
+    };
+
+    const auto it = thresholds.constFind(paramCode.toUpper());
+    return it == thresholds.constEnd() ? nullptr : &it.value();
+}
+
+int level(const Thresholds &limits, float value) {
+    if (std::isnan(value) || value < 0) return AirQualityCalculator::NoIndex;
+    //progi rosną, więc poziom to liczba przekroczonych granic
+    return int(std::upper_bound(limits.upper, limits.upper + AirQualityCalculator::MaxLevel, value,
+                                [](float v, float limit) { return v <= limit; }) - limits.upper);
+}
+
+//najnowszy wiersz kolumny z wartością, nie starszy niż maxAge godzin od ostatniego wiersza
+int latestRow(const QVector<float> &column, int maxAge) {
+    for (int row = column.size() - 1; row >= 0 && row >= column.size() - 1 - maxAge; --row) {
+        if (!std::isnan(column[row])) return row;
+    }
+    return -1;
+}
+
+}
+
+int AirQualityCalculator::IndexHistory::levelAt(qint64 time) const {
+    if (time < start) return NoIndex;
+    const qint64 row = (time - start) / SeriesFrame::Step;
+    return row < levels.size() ? levels[int(row)] : NoIndex;
+}
+
+int AirQualityCalculator::levelFor(const QString &paramCode, double value) {
+    const Thresholds *limits = thresholdsFor(paramCode);
+    return limits ? level(*limits, float(value)) : NoIndex;
+}
+
+AirQualityIndex::IndexLevel AirQualityCalculator::indexLevel(int level) {
+    static const QString names[] = {"Bardzo dobry", "Dobry", "Umiarkowany", "Dostateczny", "Zły", "Bardzo zły"};
+    if (level < 0 || level > MaxLevel) return {NoIndex, "Brak indeksu"};
+    return {level, names[level]};
+}
+
+AirQualityCalculator::IndexHistory AirQualityCalculator::history(int stationId, const QVector<Measurement> &series) {
+    IndexHistory result;
+    result.stationId = stationId;
+
+    const SeriesFrame frame = SeriesFrame::align(series);
+    if (frame.isEmpty()) return result;
+
+    result.start = frame.timeAt(0);
+    result.levels.fill(NoIndex, frame.rows());
+
+    //indeks ogólny to maksimum poziomów - kolumna po kolumnie
+    for (int c = 0; c < frame.columns(); ++c) {
+        const Thresholds *limits = thresholdsFor(frame.label(c));
+        if (!limits) continue;
+
+        const QVector<float> &column = frame.column(c);
+        for (int row = 0; row < frame.rows(); ++row) {
+            const int value = level(*limits, column[row]);
+            if (value > result.levels[row]) result.levels[row] = qint8(value);
+        }
+    }
+
+    return result;
+}
+
+AirQualityIndex AirQualityCalculator::latest(int stationId, const QVector<Measurement> &series) {
+    const SeriesFrame frame = SeriesFrame::align(series);
+    if (frame.isEmpty()) return AirQualityIndex();
+
+    const QDateTime calcDate = QDateTime::fromSecsSinceEpoch(frame.timeAt(frame.rows() - 1));
+    QVector<AirQualityIndex::StationData> readings;
+    int overall = NoIndex;
+    qint64 sourceTime = 0;
+
+    for (int c = 0; c < frame.columns(); ++c) {
+        const Thresholds *limits = thresholdsFor(frame.label(c));
+        if (!limits) continue;
+
+        const int row = latestRow(frame.column(c), 3);
+        if (row < 0) continue;
+
+        const int value = level(*limits, frame.column(c)[row]);
+        readings.append({frame.label(c), indexLevel(value), QDateTime::fromSecsSinceEpoch(frame.timeAt(row))});
+        overall = std::max(overall, value);
+        sourceTime = std::max(sourceTime, frame.timeAt(row));
+    }
+
+    if (overall == NoIndex) return AirQualityIndex();
+    return AirQualityIndex(stationId, calcDate, indexLevel(overall),
+                           QDateTime::fromSecsSinceEpoch(sourceTime), readings);
+}
+
+QVector<AirQualityCalculator::IndexHistory> AirQualityCalculator::histories(const QHash<int, QVector<Measurement>> &stations) {
+    const QVector<int> ids(stations.keyBegin(), stations.keyEnd());
+    return QtConcurrent::blockingMapped<QVector<IndexHistory>>(ids, [&stations](int stationId) {
+        return history(stationId, stations.value(stationId));
+    });
+}
+
+QVector<AirQualityIndex> AirQualityCalculator::latestAll(const QHash<int, QVector<Measurement>> &stations) {
+    const QVector<int> ids(stations.keyBegin(), stations.keyEnd());
+    QVector<AirQualityIndex> indices = QtConcurrent::blockingMapped<QVector<AirQualityIndex>>(ids, [&stations](int stationId) {
+        return latest(stationId, stations.value(stationId));
+    });
+
+    indices.erase(std::remove_if(indices.begin(), indices.end(),
+                                 [](const AirQualityIndex &index) { return !index.isValid(); }),
+                  indices.end());
+    return indices;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include "AirQualityIndex.h"
+#include "Measurement.h"
+
+/**
+ * @file airqualitycalculator.h
+ * @brief Definicja klasy AirQualityCalculator - lokalnego wyznaczania indeksu jakości powietrza
+ */
+
+/**
+ * @class AirQualityCalculator
+ * @brief Wyznacza indeks jakości powietrza z zapisanych pomiarów według progów GIOŚ
+ *
+ * Indeks każdego zanieczyszczenia wynika ze stężenia godzinowego, a indeks ogólny
+ * stacji jest najgorszym z indeksów zanieczyszczeń w danej godzinie. Serie stacji
+ * są wyrównywane do siatki godzinowej (SeriesFrame), więc historia indeksu całej
+ * stacji powstaje jednym przejściem po kolumnach. Wiele stacji jest liczonych
+ * równolegle w puli wątków (QtConcurrent) - bez zapytań do API.
+ */
+class AirQualityCalculator {
+public:
+    static constexpr int NoIndex = -1; ///< Brak indeksu (brak danych lub parametr bez progów)
+    static constexpr int MaxLevel = 5; ///< Najgorszy poziom ("Bardzo zły")
+
+    /**
+     * @struct IndexHistory
+     * @brief Godzinowa historia indeksu ogólnego stacji
+     */
+    struct IndexHistory {
+        int stationId = 0;        ///< ID stacji
+        qint64 start = 0;         ///< Czas pierwszej godziny w sekundach od epoki
+        QVector<qint8> levels;    ///< Poziom indeksu w kolejnych godzinach (NoIndex - brak)
+
+        /**
+         * @brief Zwraca poziom indeksu w godzinie zawierającej podany czas
+         * @param time Czas w sekundach od epoki
+         * @return Poziom indeksu lub NoIndex
+         */
+        int levelAt(qint64 time) const;
+    };
+
+    /**
+     * @brief Wyznacza poziom indeksu dla stężenia godzinowego zanieczyszczenia
+     * @param paramCode Kod parametru (PM10, PM2.5, O3, NO2, SO2)
+     * @param value Stężenie w µg/m³
+     * @return Poziom 0-5 lub NoIndex dla parametru bez progów i brakującej wartości
+     */
+    static int levelFor(const QString &paramCode, double value);
+
+    /**
+     * @brief Zwraca poziom indeksu w postaci używanej przez API GIOŚ
+     * @param level Poziom 0-5 lub NoIndex
+     * @return Poziom z nazwą (np. "Dobry", "Brak indeksu")
+     */
+    static AirQualityIndex::IndexLevel indexLevel(int level);
+
+    /**
+     * @brief Wyznacza godzinową historię indeksu ogólnego stacji
+     * @param stationId ID stacji
+     * @param series Serie czujników stacji (kod parametru z Measurement::paramCode())
+     * @return Historia od najstarszej do najnowszej godziny z pomiarami
+     */
+    static IndexHistory history(int stationId, const QVector<Measurement> &series);
+
+    /**
+     * @brief Wyznacza aktualny indeks stacji
+     * @param stationId ID stacji
+     * @param series Serie czujników stacji
+     * @return Indeks dla najnowszej godziny wraz z indeksami zanieczyszczeń
+     * @note Zanieczyszczenie bez pomiaru w najnowszej godzinie bierze wartość sprzed maks. 3 godzin
+     */
+    static AirQualityIndex latest(int stationId, const QVector<Measurement> &series);
+
+    /**
+     * @brief Wyznacza historie indeksu wielu stacji równolegle
+     * @param stations Serie czujników według ID stacji
+     * @return Historie wszystkich stacji
+     */
+    static QVector<IndexHistory> histories(const QHash<int, QVector<Measurement>> &stations);
+
+    /**
+     * @brief Wyznacza aktualne indeksy wielu stacji równolegle
+     * @param stations Serie czujników według ID stacji
+     * @return Indeksy stacji, dla których dało się wyznaczyć indeks ogólny
+     */
+    static QVector<AirQualityIndex> latestAll(const QHash<int, QVector<Measurement>> &stations);
+};
@@ -1,12 +1,13 @@
 #include "AirQualityIndex.h"
+#include "TimestampParser.h"
 #include <QDebug>
 #include <QColor>
 
 AirQualityIndex::AirQualityIndex(const QJsonObject &json) {
     //parsowanie podstawowych pól
     m_stationId = json["id"].toInt();
-    m_calcDate = QDateTime::fromString(json["stCalcDate"].toString(), Qt::ISODate);
-    m_sourceDataDate = QDateTime::fromString(json["stSourceDataDate"].toString(), Qt::ISODate);
+    m_calcDate = TimestampParser::toDateTime(TimestampParser::parse(json["stCalcDate"].toString()));
+    m_sourceDataDate = TimestampParser::toDateTime(TimestampParser::parse(json["stSourceDataDate"].toString()));
 
     //parsowanie głównego indeksu
     QJsonObject indexObj = json["stIndexLevel"].toObject();
@@ -20,7 +21,7 @@ AirQualityIndex::AirQualityIndex(const QJsonObject &json) {
         StationData data;
 
         data.paramName = stationObj["paramName"].toString();
-        data.calcDate = QDateTime::fromString(stationObj["calcDate"].toString(), Qt::ISODate);
+        data.calcDate = TimestampParser::toDateTime(TimestampParser::parse(stationObj["calcDate"].toString()));
 
         QJsonObject levelObj = stationObj["indexLevel"].toObject();
         data.level.id = levelObj["id"].toInt();
@@ -30,6 +31,11 @@ AirQualityIndex::AirQualityIndex(const QJsonObject &json) {
     }
 }
 
+AirQualityIndex::AirQualityIndex(int stationId, const QDateTime &calcDate, const IndexLevel &overall,
+                                 const QDateTime &sourceDataDate, const QVector<StationData> &readings)
+    : m_index(overall.id), m_stationId(stationId), m_calcDate(calcDate), m_overallIndex(overall),
+      m_sourceDataDate(sourceDataDate), m_stationReadings(readings) {}
+
 QString AirQualityIndex::toString() const {
     if (!isValid()) {
         return "Brak danych o jakości powietrza";
@@ -43,8 +49,11 @@ bool AirQualityIndex::isValid() const {
 
 QColor AirQualityIndex::getQualityColor() const {
     if (!isValid()) return Qt::gray;
+    return colorForLevel(m_overallIndex.id);
+}
 
-    switch (m_overallIndex.id) {
+QColor AirQualityIndex::colorForLevel(int level) {
+    switch (level) {
     case 0: return QColor(0, 228, 0);
     case 1: return QColor(177, 255, 129);
     case 2: return QColor(255, 255, 0);
@@ -54,6 +54,17 @@ public:
      */
     AirQualityIndex(const QJsonObject &json);
 
+    /**
+     * @brief Konstruktor tworzący indeks wyznaczony lokalnie z pomiarów
+     * @param stationId Identyfikator stacji
+     * @param calcDate Godzina, dla której wyznaczono indeks
+     * @param overall Ogólny poziom indeksu
+     * @param sourceDataDate Czas najnowszego użytego pomiaru
+     * @param readings Poziomy indeksu poszczególnych zanieczyszczeń
+     */
+    AirQualityIndex(int stationId, const QDateTime &calcDate, const IndexLevel &overall,
+                    const QDateTime &sourceDataDate, const QVector<StationData> &readings);
+
     // Funkcje dostępowe
 
     /**
@@ -92,6 +103,13 @@ public:
      */
     QColor getQualityColor() const;
 
+    /**
+     * @brief Zwraca kolor poziomu indeksu
+     * @param level Identyfikator poziomu (0-5)
+     * @return Kolor poziomu lub szary dla nieznanego poziomu
+     */
+    static QColor colorForLevel(int level);
+
     // Metody pomocnicze
 
     /**
@@ -114,7 +132,7 @@ public:
 
 private:
     int m_index;                /**< Wartość indeksu jakości powietrza */
-    int m_stationId;            /**< Identyfikator stacji pomiarowej */
+    int m_stationId = 0;        /**< Identyfikator stacji pomiarowej */
     QDateTime m_calcDate;       /**< Data i czas obliczenia wskaźnika */
     IndexLevel m_overallIndex;  /**< Ogólny wskaźnik jakości powietrza */
     QDateTime m_sourceDataDate; /**< Data i czas źródłowych danych pomiarowych */
@@ -0,0 +1,99 @@
+#include "AnomalyDetector.h"
+#include "TimestampParser.h"
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//współczynniki wygładzania: szybki poziom, wolna skala i profil dobowy
+constexpr float LevelAlpha = 0.3f;
+constexpr float ScaleAlpha = 0.05f;
+constexpr float HourlyAlpha = 0.1f;
+
+//średnie odchylenie bezwzględne -> odchylenie standardowe (rozkład normalny)
+constexpr float ScaleToSigma = 1.2533f;
+
+//minimalna skala - szum przy bardzo czystym powietrzu nie daje fałszywych skoków
+constexpr float MinSigma = 2.0f;
+
+//przerwa w danych, po której poziom budujemy od nowa
+constexpr qint64 MaxGapSecs = 24 * 3600;
+
+constexpr quint8 MinHourlyCount = 7;
+
+}
+
+AnomalyDetector::AnomalyDetector(const QString &paramCode)
+    //CO jest podawany w µg/m³ i ma o rząd wielkości wyższe stężenia
+    : m_maxPlausible(paramCode.compare("CO", Qt::CaseInsensitive) == 0 ? 50000.0f : 2000.0f) {}
+
+quint8 AnomalyDetector::update(qint64 time, float value) {
+    if (std::isnan(value)) return None;
+
+    quint8 flags = None;
+    if (value < 0 || value > m_maxPlausible) {
+        //wartość spoza zakresu nie wchodzi do stanu
+        m_lastTime = time;
+        return OutOfRange;
+    }
+
+    if (m_count > 0 && time - m_lastTime > MaxGapSecs) {
+        m_count = 0;
+        m_repeats = 0;
+    }
+
+    //ta sama wartość przez wiele godzin - zawieszony czujnik
+    m_repeats = value == m_lastValue ? m_repeats + 1 : 0;
+    if (m_repeats >= FlatlineHours - 1) flags |= Flatline;
+
+    const float sigma = std::max(m_scale * ScaleToSigma, MinSigma);
+    float clipped = value;
+    if (m_count >= WarmupPoints) {
+        const float z = (value - m_level) / sigma;
+        if (z > Threshold) {
+            flags |= Spike;
+            clipped = m_level + Threshold * sigma;
+        } else if (z < -Threshold) {
+            clipped = m_level - Threshold * sigma;
+        }
+    }
+
+    const int hour = int(((time + TimestampParser::warsawOffsetSecs(time)) / 3600) % 24);
+    if (hour >= 0 && m_hourlyCount[hour] >= MinHourlyCount &&
+        std::abs(value - m_hourly[hour]) > Threshold * sigma * 1.5f) {
+        flags |= SeasonalDeviation;
+    }
+
+    //aktualizacja stanu przyciętą wartością (odporność na pojedyncze epizody)
+    if (m_count == 0) {
+        m_level = value;
+        m_scale = 0;
+    } else {
+        m_scale += ScaleAlpha * (std::abs(clipped - m_level) - m_scale);
+        m_level += LevelAlpha * (clipped - m_level);
+    }
+    ++m_count;
+
+    if (hour >= 0) {
+        if (m_hourlyCount[hour] == 0) {
+            m_hourly[hour] = clipped;
+        } else {
+            m_hourly[hour] += HourlyAlpha * (clipped - m_hourly[hour]);
+        }
+        if (m_hourlyCount[hour] < MinHourlyCount) m_hourlyCount[hour]++;
+    }
+
+    m_lastValue = value;
+    m_lastTime = time;
+    return flags;
+}
+
+QString AnomalyDetector::describe(quint8 flags) {
+    QStringList names;
+    if (flags & Spike) names << "Skok";
+    if (flags & SeasonalDeviation) names << "Nietypowe dla pory dnia";
+    if (flags & Flatline) names << "Stała wartość";
+    if (flags & OutOfRange) names << "Poza zakresem";
+    return names.join(", ");
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <QString>
+#include <QtGlobal>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file anomalydetector.h
+ * @brief Definicja klasy AnomalyDetector - strumieniowego wykrywania anomalii pomiarów
+ */
+
+/**
+ * @class AnomalyDetector
+ * @brief Wykrywa skoki stężeń i usterki czujnika na bieżąco, punkt po punkcie
+ *
+ * Stan jednego czujnika ma stały rozmiar: wykładnicza średnia krocząca (EWMA) poziomu,
+ * odporna skala odchyleń (EWMA odchyleń bezwzględnych), średnie dla każdej godziny doby
+ * oraz licznik powtórzeń ostatniej wartości. Punkty oznaczone jako skok są przycinane
+ * przed aktualizacją stanu, więc pojedynczy epizod nie zawyża linii bazowej.
+ * Punkty muszą być podawane chronologicznie.
+ */
+class AnomalyDetector {
+public:
+    /**
+     * @enum Flag
+     * @brief Flagi anomalii punktu (maska bitowa)
+     */
+    enum Flag : quint8 {
+        None = 0,               ///< Brak anomalii
+        Spike = 1,              ///< Nagły skok względem bieżącego poziomu
+        SeasonalDeviation = 2,  ///< Odchylenie od typowej wartości dla tej godziny doby
+        Flatline = 4,           ///< Wartość niezmienna przez wiele godzin (podejrzenie usterki)
+        OutOfRange = 8          ///< Wartość fizycznie nieprawdopodobna
+    };
+
+    static constexpr int WarmupPoints = 24;    ///< Liczba punktów przed pierwszą oceną skoków
+    static constexpr int FlatlineHours = 6;    ///< Liczba powtórzeń wartości uznawana za usterkę
+    static constexpr float Threshold = 4.0f;   ///< Próg odpornego z-score
+
+    /**
+     * @brief Konstruktor
+     * @param paramCode Kod parametru - wyznacza zakres wartości prawdopodobnych
+     */
+    explicit AnomalyDetector(const QString &paramCode = QString());
+
+    /**
+     * @brief Ocenia kolejny punkt i aktualizuje stan
+     * @param time Czas pomiaru w sekundach od epoki (nowszy niż lastTime())
+     * @param value Wartość pomiaru
+     * @return Maska flag anomalii punktu
+     */
+    quint8 update(qint64 time, float value);
+
+    qint64 lastTime() const { return m_lastTime; } ///< Czas ostatniego ocenionego punktu
+    int count() const { return m_count; } ///< Liczba punktów w bieżącym poziomie
+
+    /**
+     * @brief Zwraca opis flag do wyświetlenia
+     * @param flags Maska flag
+     * @return Nazwy flag rozdzielone przecinkami (pusty napis dla None)
+     */
+    static QString describe(quint8 flags);
+
+private:
+    float m_maxPlausible;           ///< Górna granica wartości prawdopodobnych
+    float m_level = 0;              ///< EWMA poziomu
+    float m_scale = 0;              ///< EWMA odchyleń bezwzględnych od poziomu
+    int m_count = 0;                ///< Liczba punktów od rozpoczęcia lub przerwy w danych
+    float m_hourly[24] = {};        ///< EWMA wartości dla godzin doby (czas polski)
+    quint8 m_hourlyCount[24] = {};  ///< Liczba punktów w średnich godzinowych (do nasycenia)
+    float m_lastValue = NAN;        ///< Ostatnia wartość
+    int m_repeats = 0;              ///< Liczba kolejnych powtórzeń ostatniej wartości
+    qint64 m_lastTime = std::numeric_limits<qint64>::min(); ///< Czas ostatniego punktu
+};
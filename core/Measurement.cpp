@@ -1,8 +1,74 @@
 #include "Measurement.h"
+#include "TimestampParser.h"
+#include "SeriesStatistics.h"
+#include "AnomalyDetector.h"
 #include <QDebug>
 #include <algorithm>
 #include <QJsonArray>
+#include <QSet>
 #include <cmath>
+#include <numeric>
+#include <QtAlgorithms>
+
+namespace {
+
+//float przechowuje ok. 7 cyfr znaczących - odtwarzamy krótki zapis dziesiętny wartości z API
+double widen(float value) {
+    if (!std::isfinite(value) || value == 0.0f) return value;
+    const double scale = std::pow(10.0, 6 - std::floor(std::log10(std::fabs(double(value)))));
+    return std::round(value * scale) / scale;
+}
+
+/**
+ * Wspólny opis statystyk obu ścieżek analizy (przyrostowej i SeriesStatistics).
+ * Minimum i maksimum są pierwszym wystąpieniem w kolejności serii, czyli najnowszym.
+ */
+struct StatisticsSummary {
+    qint64 count = 0;
+    float min = NAN;
+    float max = NAN;
+    double mean = NAN;
+    double variance = NAN;
+    double slopePerHour = NAN;
+    QDateTime minTime;
+    QDateTime maxTime;
+};
+
+//klasyfikacja trendu na podstawie współczynnika regresji
+void describeTrend(Measurement::AnalysisResult &result, qint64 count, double avgChangePerHour) {
+    result.trend = "Za mało danych";
+    result.trendValue = 0;
+    if (count < 2 || std::isnan(avgChangePerHour)) return;
+
+    if (std::abs(avgChangePerHour) < 0.01) {
+        result.trend = "<span style='color:black;'>Stabilne</span>";
+    } else if (avgChangePerHour >= 0.01) {
+        result.trend = QString("<span style='color:green;'>Wzrost (%1/h)</span>")
+        .arg(avgChangePerHour, 0, 'f', 3);
+    } else {
+        result.trend = QString("<span style='color:red;'>Spadek (%1/h)</span>")
+        .arg(avgChangePerHour, 0, 'f', 3);
+    }
+    result.trendValue = avgChangePerHour;
+}
+
+//jedno odwzorowanie na AnalysisResult - wartości skrajne przez widen(), jak w pointAt
+Measurement::AnalysisResult toAnalysisResult(const StatisticsSummary &summary) {
+    Measurement::AnalysisResult result;
+    result.minValue = widen(summary.min);
+    result.maxValue = widen(summary.max);
+    result.avgValue = summary.count > 0 ? summary.mean : NAN;
+    result.stdDev = std::sqrt(summary.variance);
+    result.minTime = summary.minTime;
+    result.maxTime = summary.maxTime;
+    describeTrend(result, summary.count, summary.slopePerHour);
+    return result;
+}
+
+}
+
+Measurement::Measurement(const QString &paramCode, int sensorId)
+    : m_paramCode(paramCode), m_sensorId(sensorId) {}
 
 Measurement::Measurement(const QJsonObject &json) {
 
@@ -31,172 +97,275 @@ Measurement::Measurement(const QJsonObject &json) {
             if (!value.isObject()) continue;
 
             QJsonObject pointObj = value.toObject();
-            DataPoint point;
+            qint64 time = InvalidTime;
+            double pointValue = NAN;
+            bool isValid = false;
 
             //parsowanie timestampu
             if (pointObj.contains("date")) {
-                point.timestamp = QDateTime::fromString(
-                    pointObj["date"].toString(),
-                    "yyyy-MM-dd HH:mm:ss"
-                    );
+                time = TimestampParser::parse(pointObj["date"].toString());
             }
 
             //parsowanie wartości
-            if (pointObj.contains("value")) {
-                if (pointObj["value"].isNull()) {
-                    point.value = NAN;
-                    point.isValid = false;
-                } else {
-                    bool ok;
-                    double val = pointObj["value"].toVariant().toDouble(&ok);
-                    point.value = ok ? val : NAN;
-                    point.isValid = ok;
-                }
+            if (pointObj.contains("value") && !pointObj["value"].isNull()) {
+                bool ok;
+                double val = pointObj["value"].toVariant().toDouble(&ok);
+                pointValue = ok ? val : NAN;
+                isValid = ok;
             }
 
-            m_data.append(point);
+            appendPoint(time, pointValue, isValid);
         }
     }
 
+    //API zwraca punkty od najnowszego, sortowanie zadziała tylko gdy kolejność jest inna
+    sortByTime();
+
+}
+
+void Measurement::setParamCode(const QString &paramCode) { m_paramCode = paramCode; }
+
+void Measurement::reserve(int size) {
+    m_times.reserve(size);
+    m_values.reserve(size);
+    m_validBits.reserve((size + 63) / 64);
+    m_flags.reserve(size);
+}
+
+qint64 Measurement::toEpoch(const QDateTime &time) {
+    return time.isValid() ? time.toSecsSinceEpoch() : InvalidTime;
+}
+
+QDateTime Measurement::fromEpoch(qint64 epochSecs) {
+    return epochSecs == InvalidTime ? QDateTime() : QDateTime::fromSecsSinceEpoch(epochSecs);
+}
+
+void Measurement::appendPoint(const DataPoint &point) {
+    appendPoint(toEpoch(point.timestamp), point.value, point.isValid, point.flags);
+}
+
+void Measurement::appendPoint(qint64 epochSecs, double value, bool isValid, quint8 flags) {
+    const int index = m_times.size();
+    if ((index & 63) == 0) {
+        m_validBits.append(0);
+    }
+    if (isValid) {
+        m_validBits[index >> 6] |= quint64(1) << (index & 63);
+    }
+    if (index > 0 && epochSecs > m_times.last()) {
+        m_sorted = false;
+    }
+
+    m_times.append(epochSecs);
+    m_values.append(float(value));
+    m_flags.append(flags);
+
+    //statystyki liczymy na zapisanej wartości, tak jak SeriesStatistics
+    if (isValid) {
+        m_running.add(m_values.last(), epochSecs, epochSecs != InvalidTime);
+    }
+}
+
+QDateTime Measurement::timeAt(int index) const { return fromEpoch(m_times[index]); }
+
+double Measurement::valueAt(int index) const {
+    return widen(m_values[index]);
+}
+
+Measurement::DataPoint Measurement::pointAt(int index) const {
+    return {timeAt(index), valueAt(index), isValidAt(index), m_flags[index]};
+}
+
+QVector<Measurement::DataPoint> Measurement::data() const {
+    QVector<DataPoint> points;
+    points.reserve(size());
+    for (int i = 0; i < size(); ++i) {
+        points.append(pointAt(i));
+    }
+    return points;
+}
+
+Measurement Measurement::newerThan(const QDateTime &since) const {
+    Measurement result(m_paramCode, m_sensorId);
+    if (!since.isValid()) {
+        result.m_times = m_times;
+        result.m_values = m_values;
+        result.m_validBits = m_validBits;
+        result.m_flags = m_flags;
+        result.m_sorted = m_sorted;
+        result.m_running = m_running;
+        return result;
+    }
+
+    //punkty nowsze niż since tworzą początek uporządkowanej serii
+    const View newer = range(since.addSecs(1), QDateTime());
+    result.reserve(newer.size());
+    for (int i = 0; i < newer.size(); ++i) {
+        result.appendPoint(newer.epochAt(i), newer.valueAt(i), newer.isValidAt(i), newer.flagsAt(i));
+    }
+    return result;
+}
+
+void Measurement::merge(const QVector<DataPoint> &points) {
+    QSet<qint64> present;
+    present.reserve(size());
+    for (qint64 time : m_times) {
+        present.insert(time);
+    }
+
+    for (const DataPoint &point : points) {
+        if (!present.contains(toEpoch(point.timestamp))) {
+            appendPoint(point);
+        }
+    }
+
+    sortByTime();
+}
+
+int Measurement::detectAnomalies(AnomalyDetector &detector) {
+    Q_ASSERT(m_sorted);
+
+    //seria jest od najnowszego - detektor dostaje punkty od końca
+    int flagged = 0;
+    for (int i = size() - 1; i >= 0; --i) {
+        if (!isValidAt(i) || m_times[i] == InvalidTime || m_times[i] <= detector.lastTime()) continue;
+
+        m_flags[i] = detector.update(m_times[i], m_values[i]);
+        if (m_flags[i] != AnomalyDetector::None) ++flagged;
+    }
+    return flagged;
+}
+
+void Measurement::sortByTime() {
+    if (m_sorted) return;
+
+    //sortujemy indeksy i przestawiamy wszystkie kolumny naraz
+    QVector<int> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_times[a] > m_times[b];
+    });
+
+    Measurement sorted(m_paramCode, m_sensorId);
+    sorted.reserve(size());
+    for (int index : order) {
+        sorted.appendPoint(m_times[index], m_values[index], isValidAt(index), m_flags[index]);
+    }
+    m_times.swap(sorted.m_times);
+    m_values.swap(sorted.m_values);
+    m_validBits.swap(sorted.m_validBits);
+    m_flags.swap(sorted.m_flags);
+    m_sorted = true;
 }
 
 QString Measurement::toString() const {
     QString result = QString("Parametr: %1\nMeasurements:\n").arg(m_paramCode);
-    for (const DataPoint& point : m_data) {
+    for (int i = 0; i < size(); ++i) {
         result += QString("- %1: %2\n")
-        .arg(point.timestamp.toString("yyyy-MM-dd HH:mm"),
-             std::isnan(point.value) ? "NULL" : QString::number(point.value));
+        .arg(timeAt(i).toString("yyyy-MM-dd HH:mm"),
+             std::isnan(m_values[i]) ? "NULL" : QString::number(m_values[i]));
     }
     return result;
 }
 
-//implementacje metod analizy danych
-double Measurement::maxValue() const {
-    double max = NAN;
-    for (const DataPoint& point : m_data) {
-        if (point.isValid && (!std::isnan(point.value) && (std::isnan(max) || point.value > max))) {
-            max = point.value;
-        }
-    }
-    return max;
+//statystyki całej serii są utrzymywane przyrostowo w appendPoint
+double Measurement::maxValue() const { return widen(m_running.max); }
+
+double Measurement::minValue() const { return widen(m_running.min); }
+
+double Measurement::avgValue() const { return m_running.count > 0 ? m_running.mean : NAN; }
+
+QDateTime Measurement::dateOfMaxValue() const {
+    return m_running.count > 0 ? fromEpoch(m_running.maxTime) : QDateTime();
 }
 
-double Measurement::avgValue() const {
-    double sum = 0;
-    int count = 0;
-    for (const DataPoint& point : m_data) {
-        if (point.isValid && !std::isnan(point.value)) {
-            sum += point.value;
-            count++;
-        }
+SeriesStatistics Measurement::latestWindow(qint64 spanSecs) const {
+    Q_ASSERT(m_sorted);
+
+    //najnowszy pomiar z czasem jest na początku serii
+    if (isEmpty() || m_times.first() == InvalidTime) {
+        return SeriesStatistics();
     }
-    return count > 0 ? sum / count : NAN;
+    const qint64 newest = m_times.first();
+    return SeriesStatistics::compute(rangeSecs(newest - spanSecs + 1, newest));
 }
 
 int Measurement::validCount() const {
-    return std::count_if(m_data.begin(), m_data.end(),
-                         [](const DataPoint& p) { return p.isValid; });
+    int count = 0;
+    for (quint64 word : m_validBits) {
+        count += qPopulationCount(word);
+    }
+    return count;
 }
 
 double Measurement::dataCompleteness() const {
-    if (m_data.empty()) return 0;
-    return (validCount() * 100.0) / m_data.size();
+    if (isEmpty()) return 0;
+    return (validCount() * 100.0) / size();
 }
 
-QVector<Measurement::DataPoint> Measurement::filterByDateRange(const QDateTime& from, const QDateTime& to) const
-{
-    QVector<DataPoint> result;
+Measurement::View Measurement::view() const {
+    return View(this, 0, size());
+}
 
-    for (const auto& point : m_data) {
-        bool matches = true;
-        if (from.isValid() && point.timestamp < from) {
-            matches = false;
-        }
-        if (to.isValid() && point.timestamp > to) {
-            matches = false;
-        }
-        if (matches) {
-            result.append(point);
-        }
+Measurement::View Measurement::range(const QDateTime& from, const QDateTime& to) const
+{
+    Q_ASSERT(m_sorted);
+    if (!from.isValid() && !to.isValid()) {
+        return view();
     }
 
-    return result;
+    //porównania na liczbach całkowitych zamiast QDateTime, punkty bez czasu odpadają
+    return rangeSecs(from.isValid() ? from.toSecsSinceEpoch() : InvalidTime + 1,
+                     to.isValid() ? to.toSecsSinceEpoch() : std::numeric_limits<qint64>::max());
 }
 
-Measurement::AnalysisResult Measurement::analyzeData() const
+Measurement::View Measurement::rangeSecs(qint64 fromSecs, qint64 toSecs) const
 {
-    AnalysisResult result;
-    result.minValue = std::numeric_limits<double>::max();
-    result.maxValue = std::numeric_limits<double>::lowest();
-    result.avgValue = 0;
-    double sum = 0;
-    int count = 0;
-    QVector<double> values;
-    QVector<double> times;
-
-    // zbieramy dane i obliczamy min/max/avg
-    for (const DataPoint& point : m_data) {
-        if (point.isValid && !std::isnan(point.value)) {
-            if (point.value < result.minValue) {
-                result.minValue = point.value;
-                result.minTime = point.timestamp;
-            }
-            if (point.value > result.maxValue) {
-                result.maxValue = point.value;
-                result.maxTime = point.timestamp;
-            }
-            sum += point.value;
-            count++;
+    //seria malejąca: najpierw punkty nowsze niż zakres, potem zakres, na końcu starsze i bez czasu
+    const auto first = std::partition_point(m_times.cbegin(), m_times.cend(),
+                                            [toSecs](qint64 time) { return time > toSecs; });
+    const auto last = std::partition_point(first, m_times.cend(),
+                                           [fromSecs](qint64 time) { return time >= fromSecs; });
 
-            values.append(point.value);
-            times.append(point.timestamp.toSecsSinceEpoch());
-        }
+    return View(this, int(first - m_times.cbegin()), int(last - m_times.cbegin()));
+}
+
+Measurement::AnalysisResult Measurement::analyzeData() const
+{
+    StatisticsSummary summary;
+    summary.count = m_running.count;
+    summary.min = m_running.min;
+    summary.max = m_running.max;
+    summary.mean = m_running.mean;
+    summary.variance = m_running.variance();
+    summary.slopePerHour = m_running.slopePerHour();
+    if (m_running.count > 0) {
+        summary.minTime = fromEpoch(m_running.minTime);
+        summary.maxTime = fromEpoch(m_running.maxTime);
     }
+    return toAnalysisResult(summary);
+}
 
-    // obliczenie średniej
-    if (count > 0) {
-        result.avgValue = sum / count;
-    } else {
-        result.minValue = NAN;
-        result.maxValue = NAN;
-        result.avgValue = NAN;
-    }
-
-    if (count > 1) {
-        double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-        int n = 0;
-
-        for (const DataPoint& p : m_data) {
-            if (p.isValid) {
-                double x = p.timestamp.toSecsSinceEpoch() / 3600.0;
-                double y = p.value;
-                sumX += x;
-                sumY += y;
-                sumXY += x * y;
-                sumX2 += x * x;
-                n++;
-            }
-        }
+Measurement::AnalysisResult Measurement::analyzeData(const View &view)
+{
+    const SeriesStatistics stats = SeriesStatistics::compute(view);
 
-        double a = (n * sumXY - sumX * sumY) / (n * sumX2 - sumX * sumX);
-        double avgChangePerHour = a;
-
-        // klasyfikacja trendu
-        if (abs(avgChangePerHour) < 0.01) {
-            result.trend = "<span style='color:black;'>Stabilne</span>";
-        } else if (avgChangePerHour >= 0.01) {
-            result.trend = QString("<span style='color:green;'>Wzrost (%1/h)</span>")
-            .arg(avgChangePerHour, 0, 'f', 3);
-        } else {
-            result.trend = QString("<span style='color:red;'>Spadek (%1/h)</span>")
-            .arg(avgChangePerHour, 0, 'f', 3);
-        }
-        result.trendValue = avgChangePerHour;
-    }
+    StatisticsSummary summary;
+    summary.count = stats.count;
+    summary.min = float(stats.min);
+    summary.max = float(stats.max);
+    summary.mean = stats.mean;
+    summary.variance = stats.variance;
+    summary.slopePerHour = stats.slopePerHour;
 
-    return result;
+    //QDateTime tworzymy tylko dla dwóch punktów wyniku
+    if (stats.argMin >= 0) summary.minTime = view.timeAt(stats.argMin);
+    if (stats.argMax >= 0) summary.maxTime = view.timeAt(stats.argMax);
+    return toAnalysisResult(summary);
 }
 
 int Measurement::sensorId() const { return m_sensorId; }
 
-QDateTime Measurement::timestamp() const { return m_data.isEmpty() ? QDateTime() : m_data.first().timestamp; }
+void Measurement::setSensorId(int sensorId) { m_sensorId = sensorId; }
+
+QDateTime Measurement::timestamp() const { return isEmpty() ? QDateTime() : timeAt(0); }
@@ -3,6 +3,11 @@
 #include <QDateTime>
 #include <QVector>
 #include <QJsonObject>
+#include <limits>
+#include "RunningStatistics.h"
+
+struct SeriesStatistics;
+class AnomalyDetector;
 
 /**
  * @file measurement.h
@@ -15,6 +20,10 @@
  *
  * Przechowuje historię pomiarów wraz z metadanymi i udostępnia
  * metody do analizy statystycznej oraz filtrowania danych.
+ * Punkty są przechowywane kolumnowo: czasy jako sekundy od epoki Unix,
+ * wartości jako float oraz bitmapa poprawności. Seria jest uporządkowana
+ * od najnowszego punktu (jak w odpowiedzi API), co pozwala wybierać zakresy
+ * dat wyszukiwaniem binarnym jako widoki bez kopiowania.
  * @ingroup DataModels
  */
 class Measurement {
@@ -27,8 +36,11 @@ public:
         QDateTime timestamp; ///< Data i czas pomiaru
         double value;        ///< Wartość pomiaru (może być NAN dla brakujących danych)
         bool isValid;        ///< Flaga poprawności danych
+        quint8 flags = 0;    ///< Flagi anomalii (AnomalyDetector::Flag)
     };
 
+    class View;
+
     /**
      * @brief Konstruktor tworzący serię pomiarów z danych JSON
      * @param json Obiekt JSON z API GIOS zawierający dane pomiarów
@@ -36,15 +48,69 @@ public:
      */
     Measurement(const QJsonObject &json);
 
+    /**
+     * @brief Konstruktor tworzący pustą serię pomiarów
+     * @param paramCode Kod parametru (np. "PM10")
+     * @param sensorId ID czujnika źródłowego
+     */
+    explicit Measurement(const QString &paramCode = QString(), int sensorId = 0);
+
     /// @name Podstawowe gettery
     /// @{
     QString paramCode() const { return m_paramCode; } ///< Zwraca kod parametru (np. "PM10")
-    const QVector<DataPoint>& data() const { return m_data; } ///< Zwraca referencję do wszystkich punktów danych
+    QVector<DataPoint> data() const; ///< Zwraca wszystkie punkty danych (widok zgodności budowany z kolumn)
+    /// @}
+
+    /// @name Dostęp kolumnowy
+    /// @{
+    static constexpr qint64 InvalidTime = std::numeric_limits<qint64>::min(); ///< Znacznik brakującego czasu
+    int size() const { return m_times.size(); } ///< Zwraca liczbę punktów
+    const QVector<qint64>& times() const { return m_times; } ///< Kolumna czasów (sekundy od epoki Unix)
+    const QVector<float>& values() const { return m_values; } ///< Kolumna wartości (NAN dla brakujących danych)
+    double valueAt(int index) const; ///< Wartość punktu rozszerzona do double jak w pointAt
+    const QVector<quint64>& validBits() const { return m_validBits; } ///< Bitmapa poprawności (bit i - punkt i)
+    bool isValidAt(int index) const { return (m_validBits[index >> 6] >> (index & 63)) & 1u; } ///< Poprawność punktu
+    const QVector<quint8>& flags() const { return m_flags; } ///< Kolumna flag anomalii
+    quint8 flagsAt(int index) const { return m_flags[index]; } ///< Flagi anomalii punktu
+    QDateTime timeAt(int index) const; ///< Czas punktu jako QDateTime
+    DataPoint pointAt(int index) const; ///< Punkt o podanym indeksie
+    /// @}
+
+    /// @name Budowanie serii
+    /// @{
+    void setParamCode(const QString &paramCode); ///< Ustawia kod parametru
+    void reserve(int size); ///< Rezerwuje miejsce na podaną liczbę punktów
+    void appendPoint(const DataPoint &point); ///< Dodaje punkt na końcu serii
+    void appendPoint(qint64 epochSecs, double value, bool isValid, quint8 flags = 0); ///< Dodaje punkt bez pośrednictwa QDateTime
+    bool isSorted() const { return m_sorted; } ///< Czy punkty są uporządkowane od najnowszego
+    void sortByTime(); ///< Porządkuje punkty od najnowszego (punkty bez czasu na końcu)
     /// @}
 
+    /**
+     * @brief Zwraca kopię serii zawierającą tylko punkty nowsze niż podany czas
+     * @param since Czas graniczny (niepoprawny QDateTime - cała seria)
+     * @return Seria z punktami o czasie większym niż since
+     */
+    Measurement newerThan(const QDateTime &since) const;
+
+    /**
+     * @brief Dołącza do serii punkty, których czasów jeszcze w niej nie ma
+     * @param points Punkty do scalenia (np. historia z bazy danych)
+     * @note Seria pozostaje uporządkowana od najnowszego punktu, jak w odpowiedzi API
+     */
+    void merge(const QVector<DataPoint> &points);
+
+    /**
+     * @brief Oznacza anomalie w punktach nowszych niż ostatni punkt ocenione przez detektor
+     * @param detector Stan detektora czujnika (aktualizowany)
+     * @return Liczba punktów z flagami
+     * @note Punkty są podawane detektorowi chronologicznie; każdy trafia do niego raz
+     */
+    int detectAnomalies(AnomalyDetector &detector);
+
     /// @name Metody pomocnicze
     /// @{
-    bool isEmpty() const { return m_data.empty(); } ///< Sprawdza czy brak danych pomiarowych
+    bool isEmpty() const { return m_times.isEmpty(); } ///< Sprawdza czy brak danych pomiarowych
     QString toString() const; ///< Generuje tekstowy opis serii pomiarów
     /// @}
 
@@ -56,15 +122,31 @@ public:
     double minValue() const; ///< Zwraca minimalną wartość pomiaru
     double avgValue() const; ///< Oblicza średnią wartość pomiarów
     QDateTime dateOfMaxValue() const; ///< Zwraca datę wystąpienia maksymalnej wartości
+    const RunningStatistics& runningStatistics() const { return m_running; } ///< Statystyki całej serii aktualizowane przy dopisywaniu
     /// @}
 
     /**
-     * @brief Filtruje dane w podanym zakresie czasowym
-     * @param from Data początkowa zakresu
-     * @param to Data końcowa zakresu
-     * @return Wektor punktów pomiarowych z wybranego zakresu
+     * @brief Zwraca statystyki najnowszego okna serii
+     * @param spanSecs Długość okna w sekundach, liczona wstecz od najnowszego pomiaru
+     * @return Statystyki punktów z okna (koszt O(log n) + rozmiar okna)
+     */
+    SeriesStatistics latestWindow(qint64 spanSecs) const;
+
+    /**
+     * @brief Zwraca widok na całą serię
+     * @return Widok obejmujący wszystkie punkty
+     */
+    View view() const;
+
+    /**
+     * @brief Wybiera punkty z podanego zakresu czasowego
+     * @param from Data początkowa zakresu (niepoprawna - bez dolnej granicy)
+     * @param to Data końcowa zakresu (niepoprawna - bez górnej granicy)
+     * @return Widok na punkty z zakresu (bez kopiowania danych)
+     * @note Wymaga uporządkowanej serii - koszt O(log n). Punkty bez czasu
+     *       należą tylko do zakresu bez żadnej granicy.
      */
-    QVector<DataPoint> filterByDateRange(const QDateTime& from, const QDateTime& to) const;
+    View range(const QDateTime& from, const QDateTime& to) const;
 
     /**
      * @struct AnalysisResult
@@ -74,6 +156,7 @@ public:
         double minValue;    ///< Minimalna wartość w serii
         double maxValue;    ///< Maksymalna wartość w serii
         double avgValue;    ///< Średnia wartość
+        double stdDev;      ///< Odchylenie standardowe (NAN gdy mniej niż dwie wartości)
         QDateTime minTime;  ///< Czas wystąpienia minimum
         QDateTime maxTime;  ///< Czas wystąpienia maksimum
         QString trend;      ///< Opis trendu (np. "wzrostowy")
@@ -83,18 +166,76 @@ public:
     /**
      * @brief Przeprowadza kompleksową analizę danych
      * @return Struktura AnalysisResult z wynikami analizy
-     * @note Wykorzystuje regresję liniową do określenia trendu
+     * @note Dla całej serii korzysta z przyrostowych statystyk (O(1)), bez
+     *       ponownego przechodzenia po punktach
      */
     AnalysisResult analyzeData() const;
 
+    /**
+     * @brief Przeprowadza analizę fragmentu serii
+     * @param view Widok na analizowane punkty
+     * @return Struktura AnalysisResult z wynikami analizy
+     * @note Trend i pozostałe statystyki liczy jądro SeriesStatistics
+     */
+    static AnalysisResult analyzeData(const View &view);
+
     /// @name Identyfikacja
     /// @{
     int sensorId() const; ///< Zwraca ID czujnika źródłowego
+    void setSensorId(int sensorId); ///< Ustawia ID czujnika (API GIOS nie zwraca go w danych)
     QDateTime timestamp() const; ///< Zwraca czas pierwszego pomiaru w serii
     /// @}
 
 private:
     QString m_paramCode;       ///< Kod parametru pomiarowego (np. "PM2.5")
-    QVector<DataPoint> m_data; ///< Kolekcja wszystkich punktów pomiarowych
-    int m_sensorId;           ///< ID czujnika z którego pochodzą pomiary
+    QVector<qint64> m_times;   ///< Czasy pomiarów w sekundach od epoki Unix (InvalidTime gdy brak)
+    QVector<float> m_values;   ///< Wartości pomiarów
+    QVector<quint64> m_validBits; ///< Bitmapa poprawności (bit i - punkt i)
+    QVector<quint8> m_flags;   ///< Flagi anomalii punktów
+    int m_sensorId = 0;       ///< ID czujnika z którego pochodzą pomiary
+    bool m_sorted = true;     ///< Czy punkty są uporządkowane od najnowszego
+    RunningStatistics m_running; ///< Statystyki całej serii aktualizowane w appendPoint
+
+    View rangeSecs(qint64 fromSecs, qint64 toSecs) const; ///< Widok na punkty z czasem w [fromSecs, toSecs]
+
+    static qint64 toEpoch(const QDateTime &time); ///< Zamienia QDateTime na sekundy (InvalidTime gdy niepoprawny)
+    static QDateTime fromEpoch(qint64 epochSecs); ///< Zamienia sekundy na QDateTime (niepoprawny dla InvalidTime)
+};
+
+/**
+ * @class Measurement::View
+ * @brief Lekki widok na ciągły fragment serii pomiarów
+ *
+ * Nie posiada danych - odwołuje się do kolumn serii, która musi istnieć
+ * dłużej niż widok. Kolejność punktów jest taka jak w serii (od najnowszego).
+ */
+class Measurement::View {
+public:
+    View() = default;
+
+    /**
+     * @brief Konstruktor widoku
+     * @param series Seria źródłowa
+     * @param begin Indeks pierwszego punktu w serii
+     * @param end Indeks za ostatnim punktem w serii
+     */
+    View(const Measurement *series, int begin, int end)
+        : m_series(series), m_begin(begin), m_end(end) {}
+
+    int size() const { return m_end - m_begin; } ///< Liczba punktów w widoku
+    bool isEmpty() const { return m_begin == m_end; } ///< Czy widok jest pusty
+    qint64 epochAt(int index) const { return m_series->m_times[m_begin + index]; } ///< Czas punktu w sekundach od epoki
+    float valueAt(int index) const { return m_series->m_values[m_begin + index]; } ///< Wartość punktu
+    bool isValidAt(int index) const { return m_series->isValidAt(m_begin + index); } ///< Poprawność punktu
+    quint8 flagsAt(int index) const { return m_series->m_flags[m_begin + index]; } ///< Flagi anomalii punktu
+    QDateTime timeAt(int index) const { return m_series->timeAt(m_begin + index); } ///< Czas punktu jako QDateTime
+    DataPoint pointAt(int index) const { return m_series->pointAt(m_begin + index); } ///< Punkt o podanym indeksie
+    const Measurement* series() const { return m_series; } ///< Seria źródłowa
+    int firstIndex() const { return m_begin; } ///< Indeks pierwszego punktu w serii
+    int endIndex() const { return m_end; } ///< Indeks za ostatnim punktem w serii
+
+private:
+    const Measurement *m_series = nullptr; ///< Seria źródłowa
+    int m_begin = 0;                       ///< Indeks pierwszego punktu w serii
+    int m_end = 0;                         ///< Indeks za ostatnim punktem w serii
 };
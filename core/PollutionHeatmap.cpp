@@ -0,0 +1,169 @@
+#include "PollutionHeatmap.h"
+#include "StationIndex.h"
+#include "AirQualityCalculator.h"
+#include <QtConcurrent>
+#include <QRect>
+#include <cmath>
+
+namespace {
+
+//kriging: wariogram wykładniczy bez efektu samorodka
+double variogram(double km, double sill, double rangeKm) {
+    return sill * (1 - std::exp(-3 * km / rangeKm));
+}
+
+//rozwiązuje układ n x n (macierz wierszami, ostatnia kolumna to prawa strona) eliminacją Gaussa
+bool solve(QVector<double> &system, int n) {
+    const int width = n + 1;
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < n; ++row) {
+            if (std::abs(system[row * width + col]) > std::abs(system[pivot * width + col])) pivot = row;
+        }
+        if (std::abs(system[pivot * width + col]) < 1e-12) return false;
+        if (pivot != col) {
+            for (int k = col; k < width; ++k) std::swap(system[col * width + k], system[pivot * width + k]);
+        }
+        for (int row = col + 1; row < n; ++row) {
+            const double factor = system[row * width + col] / system[col * width + col];
+            for (int k = col; k < width; ++k) system[row * width + k] -= factor * system[col * width + k];
+        }
+    }
+    for (int row = n - 1; row >= 0; --row) {
+        double sum = system[row * width + n];
+        for (int k = row + 1; k < n; ++k) sum -= system[row * width + k] * system[k * width + n];
+        system[row * width + n] = sum / system[row * width + row];
+    }
+    return true;
+}
+
+struct Interpolator {
+    const QVector<Station> &stations;
+    const QVector<double> &values;
+    const StationIndex &index;
+    const PollutionHeatmap::Options &options;
+    double sill;
+
+    float idw(const QVector<StationIndex::Hit> &hits) const {
+        double weighted = 0;
+        double weights = 0;
+        for (const StationIndex::Hit &hit : hits) {
+            //komórka w miejscu stacji przyjmuje jej wartość
+            if (hit.distanceKm < 1e-3) return float(values[hit.index]);
+            const double weight = 1 / std::pow(hit.distanceKm, options.power);
+            weighted += weight * values[hit.index];
+            weights += weight;
+        }
+        return float(weighted / weights);
+    }
+
+    float kriging(const QVector<StationIndex::Hit> &hits) const {
+        const int n = hits.size();
+        if (n < 3 || sill <= 0) return idw(hits);
+
+        //układ krigingu zwykłego: wagi i mnożnik Lagrange'a (suma wag = 1)
+        const int size = n + 1;
+        QVector<double> system(size * (size + 1));
+        for (int i = 0; i < n; ++i) {
+            const Station &a = stations[hits[i].index];
+            for (int j = i + 1; j < n; ++j) {
+                const double gamma = variogram(a.distanceTo(stations[hits[j].index].latitude(),
+                                                            stations[hits[j].index].longitude()),
+                                               sill, options.rangeKm);
+                system[i * (size + 1) + j] = gamma;
+                system[j * (size + 1) + i] = gamma;
+            }
+            system[i * (size + 1) + n] = 1;
+            system[n * (size + 1) + i] = 1;
+            system[i * (size + 1) + size] = variogram(hits[i].distanceKm, sill, options.rangeKm);
+        }
+        system[n * (size + 1) + size] = 1;
+
+        if (!solve(system, size)) return idw(hits);
+
+        double estimate = 0;
+        for (int i = 0; i < n; ++i) {
+            estimate += system[i * (size + 1) + size] * values[hits[i].index];
+        }
+        //kriging może dać wartość ujemną przy ujemnych wagach
+        return float(std::max(0.0, estimate));
+    }
+
+    float cell(double lat, double lon) const {
+        QVector<StationIndex::Hit> hits = index.nearest(lat, lon, options.neighbours);
+        while (!hits.isEmpty() && hits.last().distanceKm > options.maxDistanceKm) hits.removeLast();
+        if (hits.isEmpty()) return NAN;
+        return options.method == PollutionHeatmap::Method::OrdinaryKriging ? kriging(hits) : idw(hits);
+    }
+};
+
+}
+
+PollutionHeatmap::Raster PollutionHeatmap::generate(const QVector<Station> &stations, const QVector<double> &values,
+                                                    const Options &options) {
+    Raster raster;
+    raster.stepDeg = options.stepDeg;
+    raster.north = options.bounds.topLeft().latitude() - options.stepDeg / 2;
+    raster.west = options.bounds.topLeft().longitude() + options.stepDeg / 2;
+    raster.rows = int(std::ceil(options.bounds.height() / options.stepDeg));
+    raster.cols = int(std::ceil(options.bounds.width() / options.stepDeg));
+    raster.values.fill(NAN, raster.rows * raster.cols);
+
+    //tylko stacje z wartością trafiają do indeksu
+    QVector<Station> measured;
+    QVector<double> measuredValues;
+    for (int i = 0; i < stations.size(); ++i) {
+        if (std::isnan(values[i])) continue;
+        measured.append(stations[i]);
+        measuredValues.append(values[i]);
+    }
+    if (measured.isEmpty()) return raster;
+
+    const StationIndex index(measured);
+
+    //próg wariogramu: wariancja wartości stacji
+    double mean = 0;
+    for (double value : measuredValues) mean += value;
+    mean /= measuredValues.size();
+    double sill = 0;
+    for (double value : measuredValues) sill += (value - mean) * (value - mean);
+    sill /= measuredValues.size();
+
+    const Interpolator interpolator{measured, measuredValues, index, options, sill};
+
+    QVector<QRect> tiles;
+    for (int row = 0; row < raster.rows; row += options.tileSize) {
+        for (int col = 0; col < raster.cols; col += options.tileSize) {
+            tiles.append(QRect(col, row, qMin(options.tileSize, raster.cols - col),
+                               qMin(options.tileSize, raster.rows - row)));
+        }
+    }
+
+    //kafelki zapisują rozłączne komórki - bez synchronizacji
+    float *cells = raster.values.data();
+    QtConcurrent::blockingMap(tiles, [&](const QRect &tile) {
+        for (int row = tile.top(); row <= tile.bottom(); ++row) {
+            const double lat = raster.north - row * raster.stepDeg;
+            for (int col = tile.left(); col <= tile.right(); ++col) {
+                cells[row * raster.cols + col] = interpolator.cell(lat, raster.west + col * raster.stepDeg);
+            }
+        }
+    });
+
+    return raster;
+}
+
+QImage PollutionHeatmap::toImage(const Raster &raster, const QString &paramCode) {
+    QImage image(raster.cols, raster.rows, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    for (int row = 0; row < raster.rows; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(row));
+        for (int col = 0; col < raster.cols; ++col) {
+            const float value = raster.at(row, col);
+            if (std::isnan(value)) continue;
+            line[col] = AirQualityIndex::colorForLevel(AirQualityCalculator::levelFor(paramCode, value)).rgba();
+        }
+    }
+    return image;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QImage>
+#include <QGeoRectangle>
+#include "Station.h"
+
+/**
+ * @file pollutionheatmap.h
+ * @brief Definicja klasy PollutionHeatmap - interpolacji przestrzennej stężeń
+ */
+
+/**
+ * @class PollutionHeatmap
+ * @brief Zamienia wartości ze stacji na regularną siatkę stężeń nad Polską
+ *
+ * Każda komórka siatki jest interpolowana z najbliższych stacji znalezionych w indeksie
+ * przestrzennym (StationIndex) - odwrotnymi odległościami (IDW) albo krigingiem zwykłym
+ * z wykładniczym wariogramem. Siatka jest dzielona na kafelki liczone równolegle
+ * w puli wątków (QtConcurrent); kafelki zapisują rozłączne fragmenty rastra.
+ */
+class PollutionHeatmap {
+public:
+    /**
+     * @enum Method
+     * @brief Metoda interpolacji
+     */
+    enum class Method {
+        InverseDistance,    ///< Ważenie odwrotnością potęgi odległości
+        OrdinaryKriging     ///< Kriging zwykły (wariogram wykładniczy)
+    };
+
+    /**
+     * @struct Options
+     * @brief Parametry generowania rastra
+     */
+    struct Options {
+        QGeoRectangle bounds = QGeoRectangle(QGeoCoordinate(55.0, 14.0), QGeoCoordinate(49.0, 24.2)); ///< Obszar (domyślnie Polska)
+        double stepDeg = 0.05;          ///< Rozmiar komórki w stopniach
+        Method method = Method::InverseDistance; ///< Metoda interpolacji
+        int neighbours = 8;             ///< Liczba najbliższych stacji użytych dla komórki
+        double maxDistanceKm = 150;     ///< Stacje dalsze niż ta odległość są pomijane
+        double power = 2;               ///< Wykładnik IDW
+        double rangeKm = 100;           ///< Zasięg wariogramu (kriging)
+        int tileSize = 32;              ///< Bok kafelka w komórkach
+    };
+
+    /**
+     * @struct Raster
+     * @brief Siatka stężeń (wiersz 0 to północny skraj obszaru)
+     */
+    struct Raster {
+        double north = 0;       ///< Szerokość geograficzna środka pierwszego wiersza
+        double west = 0;        ///< Długość geograficzna środka pierwszej kolumny
+        double stepDeg = 0;     ///< Rozmiar komórki w stopniach
+        int rows = 0;           ///< Liczba wierszy
+        int cols = 0;           ///< Liczba kolumn
+        QVector<float> values;  ///< Wartości wierszami (NAN - brak stacji w zasięgu)
+
+        bool isEmpty() const { return values.isEmpty(); } ///< Czy raster jest pusty
+        float at(int row, int col) const { return values[row * cols + col]; } ///< Wartość komórki
+    };
+
+    /**
+     * @brief Generuje raster stężeń
+     * @param stations Stacje z wartościami
+     * @param values Wartość dla każdej stacji (ta sama kolejność; NAN - stacja pomijana)
+     * @param options Parametry generowania
+     * @return Raster obejmujący options.bounds
+     */
+    static Raster generate(const QVector<Station> &stations, const QVector<double> &values,
+                           const Options &options = Options());
+
+    /**
+     * @brief Renderuje raster w kolorach poziomów indeksu jakości powietrza
+     * @param raster Raster stężeń
+     * @param paramCode Kod parametru (wyznacza progi poziomów)
+     * @return Obraz o rozmiarze rastra; komórki bez wartości są przezroczyste
+     */
+    static QImage toImage(const Raster &raster, const QString &paramCode);
+};
@@ -0,0 +1,162 @@
+#include "QuantileSketch.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+constexpr quint8 FormatVersion = 1;
+
+//funkcja skali k1 - centroidy małe przy krańcach, duże w środku rozkładu
+double scale(double q, double compression) {
+    return compression / (2 * M_PI) * std::asin(2 * std::clamp(q, 0.0, 1.0) - 1);
+}
+
+}
+
+QuantileSketch::QuantileSketch(double compression)
+    : m_compression(compression) {}
+
+void QuantileSketch::add(double value, double weight) {
+    if (std::isnan(value) || weight <= 0) return;
+
+    if (std::isnan(m_min) || value < m_min) m_min = value;
+    if (std::isnan(m_max) || value > m_max) m_max = value;
+
+    m_buffer.append({value, weight});
+    if (m_buffer.size() >= int(m_compression) * 5) {
+        compress();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch &other) {
+    other.compress();
+    if (other.m_centroids.isEmpty()) return;
+
+    if (std::isnan(m_min) || other.m_min < m_min) m_min = other.m_min;
+    if (std::isnan(m_max) || other.m_max > m_max) m_max = other.m_max;
+
+    m_buffer += other.m_centroids;
+    if (m_buffer.size() >= int(m_compression) * 5) {
+        compress();
+    }
+}
+
+double QuantileSketch::count() const {
+    double total = 0;
+    for (const Centroid &c : m_centroids) total += c.weight;
+    for (const Centroid &c : m_buffer) total += c.weight;
+    return total;
+}
+
+void QuantileSketch::compress() const {
+    if (m_buffer.isEmpty()) return;
+
+    QVector<Centroid> all = m_centroids + m_buffer;
+    m_buffer.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid &a, const Centroid &b) {
+        return a.mean < b.mean;
+    });
+
+    double total = 0;
+    for (const Centroid &c : all) total += c.weight;
+
+    QVector<Centroid> merged;
+    merged.reserve(int(m_compression));
+    Centroid current = all.first();
+    double weightBefore = 0;
+
+    for (int i = 1; i < all.size(); ++i) {
+        const Centroid &next = all[i];
+        const double q0 = weightBefore / total;
+        const double q2 = (weightBefore + current.weight + next.weight) / total;
+
+        //scalamy dopóki centroid mieści się w jednostce funkcji skali
+        if (scale(q2, m_compression) - scale(q0, m_compression) <= 1) {
+            const double weight = current.weight + next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / weight;
+            current.weight = weight;
+        } else {
+            merged.append(current);
+            weightBefore += current.weight;
+            current = next;
+        }
+    }
+    merged.append(current);
+
+    m_centroids.swap(merged);
+}
+
+double QuantileSketch::quantile(double q) const {
+    compress();
+    if (m_centroids.isEmpty()) return NAN;
+    if (m_centroids.size() == 1) return m_centroids.first().mean;
+
+    q = std::clamp(q, 0.0, 1.0);
+    double total = 0;
+    for (const Centroid &c : m_centroids) total += c.weight;
+    const double target = q * total;
+
+    //interpolacja liniowa między środkami sąsiednich centroidów
+    const Centroid &first = m_centroids.first();
+    if (target < first.weight / 2) {
+        return m_min + (first.mean - m_min) * target / (first.weight / 2);
+    }
+
+    double cumulative = first.weight / 2;
+    for (int i = 1; i < m_centroids.size(); ++i) {
+        const Centroid &left = m_centroids[i - 1];
+        const Centroid &right = m_centroids[i];
+        const double step = (left.weight + right.weight) / 2;
+        if (target < cumulative + step) {
+            return left.mean + (right.mean - left.mean) * (target - cumulative) / step;
+        }
+        cumulative += step;
+    }
+
+    const Centroid &last = m_centroids.last();
+    const double tail = last.weight / 2;
+    return tail > 0 ? last.mean + (m_max - last.mean) * std::min(1.0, (target - cumulative) / tail) : last.mean;
+}
+
+QByteArray QuantileSketch::serialize() const {
+    compress();
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << FormatVersion << float(m_compression) << float(m_min) << float(m_max)
+           << quint32(m_centroids.size());
+    for (const Centroid &c : m_centroids) {
+        stream << float(c.mean) << float(c.weight);
+    }
+    return data;
+}
+
+QuantileSketch QuantileSketch::deserialize(const QByteArray &data) {
+    QDataStream stream(data);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint8 version = 0;
+    float compression = 0, min = 0, max = 0;
+    quint32 size = 0;
+    stream >> version >> compression >> min >> max >> size;
+    if (stream.status() != QDataStream::Ok || version != FormatVersion || compression <= 0) {
+        return QuantileSketch();
+    }
+
+    QuantileSketch sketch(compression);
+    sketch.m_min = min;
+    sketch.m_max = max;
+    sketch.m_centroids.reserve(int(size));
+    for (quint32 i = 0; i < size; ++i) {
+        float mean = 0, weight = 0;
+        stream >> mean >> weight;
+        if (stream.status() != QDataStream::Ok) {
+            return QuantileSketch();
+        }
+        sketch.m_centroids.append({mean, weight});
+    }
+    return sketch;
+}
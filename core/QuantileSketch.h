@@ -0,0 +1,86 @@
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <cmath>
+
+/**
+ * @file quantilesketch.h
+ * @brief Definicja klasy QuantileSketch - szkicu kwantyli typu t-digest
+ */
+
+/**
+ * @class QuantileSketch
+ * @brief Scalany szkic kwantyli (t-digest) o ograniczonym rozmiarze
+ *
+ * Przechowuje wartości jako centroidy (średnia, waga), gęściej przy krańcach
+ * rozkładu, dzięki czemu P95/P99 są dokładne przy niewielkim rozmiarze szkicu.
+ * Szkice dni i stacji można dowolnie scalać, a wynik nie zależy istotnie od kolejności.
+ * @ingroup DataModels
+ */
+class QuantileSketch {
+public:
+    /**
+     * @brief Konstruktor pustego szkicu
+     * @param compression Parametr kompresji (większy - dokładniej, więcej centroidów)
+     */
+    explicit QuantileSketch(double compression = 100);
+
+    /**
+     * @brief Dodaje wartość do szkicu
+     * @param value Wartość (NAN jest pomijany)
+     * @param weight Waga wartości
+     */
+    void add(double value, double weight = 1);
+
+    /**
+     * @brief Scala inny szkic z bieżącym
+     * @param other Szkic do scalenia
+     */
+    void merge(const QuantileSketch &other);
+
+    /**
+     * @brief Zwraca przybliżony kwantyl
+     * @param q Rząd kwantyla (0..1)
+     * @return Wartość kwantyla lub NAN dla pustego szkicu
+     */
+    double quantile(double q) const;
+
+    double count() const; ///< Łączna waga wartości w szkicu
+    bool isEmpty() const { return count() == 0; } ///< Czy szkic jest pusty
+    double min() const { return m_min; } ///< Najmniejsza dodana wartość
+    double max() const { return m_max; } ///< Największa dodana wartość
+
+    /**
+     * @brief Zapisuje szkic w zwartej postaci binarnej
+     * @return Dane do zapisania w bazie
+     */
+    QByteArray serialize() const;
+
+    /**
+     * @brief Odtwarza szkic z postaci binarnej
+     * @param data Dane zapisane przez serialize()
+     * @return Odtworzony szkic (pusty gdy dane są niepoprawne)
+     */
+    static QuantileSketch deserialize(const QByteArray &data);
+
+private:
+    /**
+     * @struct Centroid
+     * @brief Grupa sąsiednich wartości
+     */
+    struct Centroid {
+        double mean;   ///< Średnia wartości w grupie
+        double weight; ///< Liczba (waga) wartości w grupie
+    };
+
+    double m_compression;                   ///< Parametr kompresji
+    double m_min = NAN;                     ///< Najmniejsza wartość
+    double m_max = NAN;                     ///< Największa wartość
+    mutable QVector<Centroid> m_centroids;  ///< Skompresowane centroidy (posortowane)
+    mutable QVector<Centroid> m_buffer;     ///< Wartości jeszcze niescalone z centroidami
+
+    /**
+     * @brief Scala bufor z centroidami (leniwie, także z metod const)
+     */
+    void compress() const;
+};
@@ -0,0 +1,223 @@
+#include "RollingAnalytics.h"
+#include "TimestampParser.h"
+#include <QHash>
+#include <QDebug>
+#include <deque>
+#include <cmath>
+
+namespace {
+
+//minimalne pokrycie okien według zasad oceny jakości powietrza (75%)
+constexpr int MinHoursPerDay = 18;
+constexpr int MinHoursPer8h = 6;
+
+//numer dnia juliańskiego dla 1970-01-01
+constexpr qint64 EpochJulianDay = 2440588;
+
+//poprawne punkty widoku w kolejności chronologicznej
+struct Chronological {
+    QVector<qint64> times;
+    QVector<float> values;
+};
+
+Chronological chronological(const Measurement::View &view) {
+    Chronological points;
+    points.times.reserve(view.size());
+    points.values.reserve(view.size());
+
+    //widok jest od najnowszego, więc idziemy od końca
+    for (int i = view.size() - 1; i >= 0; --i) {
+        const qint64 time = view.epochAt(i);
+        const float value = view.valueAt(i);
+        if (time == Measurement::InvalidTime || !view.isValidAt(i) || std::isnan(value)) continue;
+        points.times.append(time);
+        points.values.append(value);
+    }
+    return points;
+}
+
+RollingAnalytics::WindowSeries window(const Chronological &points, qint64 spanSecs, int minCount) {
+    RollingAnalytics::WindowSeries result;
+    result.spanSecs = spanSecs;
+
+    //okno (t - span, t] musi zawierać co najmniej bieżący punkt
+    if (spanSecs <= 0) {
+        qWarning() << "Niepoprawna długość okna kroczącego:" << spanSecs;
+        return result;
+    }
+
+    const int n = points.times.size();
+    result.times = points.times;
+    result.mean.resize(n);
+    result.min.resize(n);
+    result.max.resize(n);
+
+    //sumy prefiksowe w double, żeby różnice nie gubiły precyzji
+    QVector<double> prefix(n + 1);
+    prefix[0] = 0;
+    for (int i = 0; i < n; ++i) {
+        prefix[i + 1] = prefix[i] + points.values[i];
+    }
+
+    std::deque<int> minQueue;
+    std::deque<int> maxQueue;
+    int left = 0;
+
+    for (int i = 0; i < n; ++i) {
+        const float value = points.values[i];
+
+        //monotoniczne kolejki: na początku zawsze minimum/maksimum okna
+        while (!minQueue.empty() && points.values[minQueue.back()] >= value) minQueue.pop_back();
+        minQueue.push_back(i);
+        while (!maxQueue.empty() && points.values[maxQueue.back()] <= value) maxQueue.pop_back();
+        maxQueue.push_back(i);
+
+        //okno (t - span, t]
+        const qint64 windowStart = points.times[i] - spanSecs;
+        while (points.times[left] <= windowStart) ++left;
+        while (minQueue.front() < left) minQueue.pop_front();
+        while (maxQueue.front() < left) maxQueue.pop_front();
+
+        const int count = i + 1 - left;
+        result.mean[i] = count >= minCount ? float((prefix[i + 1] - prefix[left]) / count) : NAN;
+        result.min[i] = points.values[minQueue.front()];
+        result.max[i] = points.values[maxQueue.front()];
+    }
+
+    return result;
+}
+
+QVector<RollingAnalytics::DailyAggregate> daily(const Chronological &points) {
+    QVector<RollingAnalytics::DailyAggregate> days;
+    const RollingAnalytics::WindowSeries means8h = window(points, RollingAnalytics::EightHours, MinHoursPer8h);
+
+    qint64 currentDay = 0;
+    double sum = 0;
+    const auto closeDay = [&days, &sum]() {
+        RollingAnalytics::DailyAggregate &day = days.last();
+        day.mean = day.count >= MinHoursPerDay ? sum / day.count : NAN;
+    };
+
+    for (int i = 0; i < points.times.size(); ++i) {
+        const qint64 dayNumber = TimestampParser::warsawDay(points.times[i]);
+        if (days.isEmpty() || dayNumber != currentDay) {
+            if (!days.isEmpty()) closeDay();
+            days.append(RollingAnalytics::DailyAggregate());
+            days.last().date = QDate::fromJulianDay(dayNumber + EpochJulianDay);
+            currentDay = dayNumber;
+            sum = 0;
+        }
+
+        RollingAnalytics::DailyAggregate &day = days.last();
+        const float value = points.values[i];
+        sum += value;
+        day.count++;
+        if (std::isnan(day.max) || value > day.max) day.max = value;
+
+        const float mean8h = means8h.mean[i];
+        if (!std::isnan(mean8h) && (std::isnan(day.max8hMean) || mean8h > day.max8hMean)) {
+            day.max8hMean = mean8h;
+        }
+    }
+    if (!days.isEmpty()) closeDay();
+
+    return days;
+}
+
+//przekroczenia z gotowych punktów i agregatów - punkty bez czasu i NaN są już odfiltrowane
+RollingAnalytics::ExceedanceReport exceedancesFor(const Chronological &points,
+                                                  const QVector<RollingAnalytics::DailyAggregate> &daily,
+                                                  const QString &paramCode) {
+    RollingAnalytics::ExceedanceReport report;
+    const RollingAnalytics::Norm *norm = RollingAnalytics::normFor(paramCode);
+    if (!norm) return report;
+
+    report.hasNorm = true;
+    report.norm = *norm;
+
+    switch (norm->type) {
+    case RollingAnalytics::NormType::DailyMean:
+        for (const RollingAnalytics::DailyAggregate &day : daily) {
+            if (std::isnan(day.mean)) continue;
+            report.coveredDays++;
+            if (day.mean > norm->limit) {
+                report.exceedances++;
+                report.days.append(day);
+            }
+        }
+        break;
+    case RollingAnalytics::NormType::Max8hMean:
+        for (const RollingAnalytics::DailyAggregate &day : daily) {
+            if (std::isnan(day.max8hMean)) continue;
+            report.coveredDays++;
+            if (day.max8hMean > norm->limit) {
+                report.exceedances++;
+                report.days.append(day);
+            }
+        }
+        break;
+    case RollingAnalytics::NormType::Hourly:
+        //każda godzina powyżej normy jest przekroczeniem, ale dzień jest oceniony
+        //tylko przy 75% pokrycia - jak dla pozostałych norm
+        for (const float value : points.values) {
+            if (value > norm->limit) report.exceedances++;
+        }
+        for (const RollingAnalytics::DailyAggregate &day : daily) {
+            if (day.count < MinHoursPerDay) continue;
+            report.coveredDays++;
+            if (day.max > norm->limit) {
+                report.days.append(day);
+            }
+        }
+        break;
+    }
+
+    return report;
+}
+
+}
+
+RollingAnalytics::WindowSeries RollingAnalytics::movingWindow(const Measurement::View &view, qint64 spanSecs, int minCount) {
+    return window(chronological(view), spanSecs, minCount);
+}
+
+QVector<RollingAnalytics::DailyAggregate> RollingAnalytics::dailyAggregates(const Measurement::View &view) {
+    return daily(chronological(view));
+}
+
+const RollingAnalytics::Norm* RollingAnalytics::normFor(const QString &paramCode) {
+    //normy krótkoterminowe (dyrektywa 2008/50/WE, rozporządzenie w sprawie poziomów substancji w powietrzu)
+    static const QHash<QString, Norm> norms = {
+        {"PM10", {"PM10", NormType::DailyMean, 50, 35, "Średnia dobowa PM10 powyżej 50 µg/m³ (dopuszczalne 35 dni w roku)"}},
+        {"SO2", {"SO2", NormType::DailyMean, 125, 3, "Średnia dobowa SO2 powyżej 125 µg/m³ (dopuszczalne 3 dni w roku)"}},
+        {"NO2", {"NO2", NormType::Hourly, 200, 18, "Stężenie godzinowe NO2 powyżej 200 µg/m³ (dopuszczalne 18 godzin w roku)"}},
+        {"O3", {"O3", NormType::Max8hMean, 120, 25, "Maksymalna średnia 8-godzinna O3 powyżej 120 µg/m³ (dopuszczalne 25 dni w roku)"}},
+        {"CO", {"CO", NormType::Max8hMean, 10000, 0, "Maksymalna średnia 8-godzinna CO powyżej 10 000 µg/m³"}}
+    };
+
+    const auto it = norms.constFind(paramCode.toUpper());
+    return it == norms.constEnd() ? nullptr : &it.value();
+}
+
+RollingAnalytics::ExceedanceReport RollingAnalytics::exceedances(const Measurement::View &view, const QString &paramCode) {
+    const Chronological points = chronological(view);
+    return exceedancesFor(points, daily(points), paramCode);
+}
+
+RollingAnalytics::Summary RollingAnalytics::summarize(const Measurement::View &view, const QString &paramCode) {
+    Summary summary;
+    const Chronological points = chronological(view);
+    if (points.times.isEmpty()) return summary;
+
+    const WindowSeries hourly = window(points, Hour, 1);
+    const WindowSeries eightHours = window(points, EightHours, MinHoursPer8h);
+    const WindowSeries fullDay = window(points, Day, MinHoursPerDay);
+    summary.latest1h = hourly.mean.last();
+    summary.latest8h = eightHours.mean.last();
+    summary.latest24h = fullDay.mean.last();
+
+    const QVector<DailyAggregate> days = daily(points);
+    summary.lastDay = days.last();
+    summary.exceedance = exceedancesFor(points, days, paramCode);
+    return summary;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <QString>
+#include <QDate>
+#include <QVector>
+#include "Measurement.h"
+
+/**
+ * @file rollinganalytics.h
+ * @brief Definicja klasy RollingAnalytics - analiz w oknach czasowych
+ */
+
+/**
+ * @class RollingAnalytics
+ * @brief Średnie kroczące, agregaty dobowe i przekroczenia norm dla serii pomiarów
+ *
+ * Okna są wyznaczane dwoma wskaźnikami po chronologicznie uporządkowanych punktach.
+ * Średnia pochodzi z sum prefiksowych, a minimum i maksimum z monotonicznych kolejek,
+ * więc wyznaczenie całej serii okien kosztuje O(n). Dni są liczone według czasu polskiego.
+ */
+class RollingAnalytics {
+public:
+    static constexpr qint64 Hour = 3600;        ///< Okno jednogodzinne
+    static constexpr qint64 EightHours = 8 * 3600; ///< Okno ośmiogodzinne
+    static constexpr qint64 Day = 24 * 3600;    ///< Okno dobowe
+
+    /**
+     * @struct WindowSeries
+     * @brief Wyniki okna kroczącego dla kolejnych punktów serii (od najstarszego)
+     */
+    struct WindowSeries {
+        qint64 spanSecs = 0;     ///< Długość okna w sekundach
+        QVector<qint64> times;   ///< Koniec okna (czas punktu) w sekundach od epoki
+        QVector<float> mean;     ///< Średnia w oknie (NAN gdy za mało wartości)
+        QVector<float> min;      ///< Minimum w oknie
+        QVector<float> max;      ///< Maksimum w oknie
+        int size() const { return times.size(); } ///< Liczba okien
+    };
+
+    /**
+     * @struct DailyAggregate
+     * @brief Agregat jednego dnia kalendarzowego
+     */
+    struct DailyAggregate {
+        QDate date;              ///< Dzień (czas polski)
+        int count = 0;           ///< Liczba poprawnych wartości godzinowych
+        double mean = NAN;       ///< Średnia dobowa (NAN gdy mniej niż 75% godzin)
+        double max = NAN;        ///< Maksymalna wartość godzinowa
+        double max8hMean = NAN;  ///< Maksymalna średnia ośmiogodzinna kończąca się w tym dniu
+    };
+
+    /**
+     * @enum NormType
+     * @brief Sposób uśredniania, którego dotyczy norma
+     */
+    enum class NormType {
+        DailyMean,  ///< Średnia dobowa
+        Max8hMean,  ///< Maksymalna dobowa średnia ośmiogodzinna
+        Hourly      ///< Wartość godzinowa
+    };
+
+    /**
+     * @struct Norm
+     * @brief Norma jakości powietrza dla parametru
+     */
+    struct Norm {
+        QString paramCode;       ///< Kod parametru (np. "PM10")
+        NormType type;           ///< Sposób uśredniania
+        double limit;            ///< Wartość graniczna (µg/m³)
+        int allowedPerYear;      ///< Dopuszczalna liczba przekroczeń w roku
+        QString description;     ///< Opis normy
+    };
+
+    /**
+     * @struct ExceedanceReport
+     * @brief Zestawienie przekroczeń normy w analizowanym zakresie
+     */
+    struct ExceedanceReport {
+        bool hasNorm = false;            ///< Czy dla parametru istnieje norma krótkoterminowa
+        Norm norm;                       ///< Zastosowana norma
+        int coveredDays = 0;             ///< Dni z danymi wystarczającymi do oceny (co najmniej 75% godzin)
+        int exceedances = 0;             ///< Liczba przekroczeń (dni, a dla normy godzinowej - godzin)
+        QVector<DailyAggregate> days;    ///< Dni, w których wystąpiło przekroczenie
+    };
+
+    /**
+     * @struct Summary
+     * @brief Podsumowanie okienkowe do wyświetlenia obok analizy serii
+     */
+    struct Summary {
+        double latest1h = NAN;           ///< Ostatnia średnia godzinowa
+        double latest8h = NAN;           ///< Ostatnia średnia ośmiogodzinna
+        double latest24h = NAN;          ///< Ostatnia średnia dobowa krocząca
+        DailyAggregate lastDay;          ///< Agregat ostatniego dnia w zakresie
+        ExceedanceReport exceedance;     ///< Przekroczenia normy
+    };
+
+    /**
+     * @brief Liczy okno kroczące dla każdego poprawnego punktu widoku
+     * @param view Widok na serię (uporządkowaną od najnowszego punktu)
+     * @param spanSecs Długość okna w sekundach (okno obejmuje (t - span, t]); dla wartości
+     *                 niedodatniej zwracana jest pusta seria
+     * @param minCount Minimalna liczba wartości w oknie, aby podać średnią
+     * @return Wyniki okien od najstarszego punktu
+     */
+    static WindowSeries movingWindow(const Measurement::View &view, qint64 spanSecs, int minCount = 1);
+
+    /**
+     * @brief Liczy agregaty dla kolejnych dni kalendarzowych
+     * @param view Widok na serię
+     * @return Agregaty dni od najstarszego
+     */
+    static QVector<DailyAggregate> dailyAggregates(const Measurement::View &view);
+
+    /**
+     * @brief Zwraca normę krótkoterminową dla parametru
+     * @param paramCode Kod parametru
+     * @return Wskaźnik na normę lub nullptr gdy brak
+     */
+    static const Norm* normFor(const QString &paramCode);
+
+    /**
+     * @brief Wyznacza przekroczenia normy w zakresie widoku
+     * @param view Widok na serię
+     * @param paramCode Kod parametru
+     * @return Zestawienie przekroczeń
+     */
+    static ExceedanceReport exceedances(const Measurement::View &view, const QString &paramCode);
+
+    /**
+     * @brief Wyznacza podsumowanie okienkowe widoku
+     * @param view Widok na serię
+     * @param paramCode Kod parametru
+     * @return Ostatnie średnie kroczące, ostatni dzień i przekroczenia normy
+     */
+    static Summary summarize(const Measurement::View &view, const QString &paramCode);
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <QtGlobal>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file runningstatistics.h
+ * @brief Definicja struktury RunningStatistics - statystyk aktualizowanych przy dopisywaniu punktów
+ */
+
+/**
+ * @struct RunningStatistics
+ * @brief Przyrostowe statystyki serii aktualizowane w O(1) na punkt
+ *
+ * Średnia i wariancja są liczone algorytmem Welforda, a trend jako iloraz
+ * współmomentu czasu i wartości przez wariancję czasu (również metodą Welforda).
+ * Wynik nie zależy od kolejności dopisywania punktów - przy równych wartościach
+ * minimum i maksimum wskazują najnowszy punkt, tak jak SeriesStatistics.
+ * @ingroup DataModels
+ */
+struct RunningStatistics {
+    qint64 count = 0;           ///< Liczba poprawnych wartości
+    double mean = 0;            ///< Bieżąca średnia
+    double m2 = 0;              ///< Suma kwadratów odchyleń od średniej
+    float min = NAN;            ///< Minimalna wartość
+    float max = NAN;            ///< Maksymalna wartość
+    qint64 minTime = std::numeric_limits<qint64>::min(); ///< Czas minimum (sekundy od epoki)
+    qint64 maxTime = std::numeric_limits<qint64>::min(); ///< Czas maksimum (sekundy od epoki)
+
+    qint64 trendCount = 0;      ///< Liczba punktów z czasem użytych w regresji
+    qint64 timeOrigin = 0;      ///< Czas pierwszego punktu regresji (punkt odniesienia osi X)
+    double meanX = 0;           ///< Średni czas w godzinach od timeOrigin
+    double meanY = 0;           ///< Średnia wartość punktów regresji
+    double m2X = 0;             ///< Suma kwadratów odchyleń czasu
+    double coXY = 0;            ///< Współmoment czasu i wartości
+
+    /**
+     * @brief Dołącza poprawną wartość do statystyk
+     * @param value Wartość pomiaru (NAN jest pomijany)
+     * @param time Czas pomiaru w sekundach od epoki
+     * @param hasTime Czy punkt ma czas (tylko takie wchodzą do regresji)
+     */
+    void add(float value, qint64 time, bool hasTime) {
+        if (std::isnan(value)) return;
+
+        ++count;
+        const double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+
+        //remis rozstrzyga nowszy punkt - jak pierwsze wystąpienie w serii od najnowszego
+        if (count == 1 || value < min || (value == min && time > minTime)) {
+            min = value;
+            minTime = time;
+        }
+        if (count == 1 || value > max || (value == max && time > maxTime)) {
+            max = value;
+            maxTime = time;
+        }
+
+        if (!hasTime) return;
+        if (trendCount == 0) {
+            timeOrigin = time;
+        }
+
+        ++trendCount;
+        const double x = (time - timeOrigin) / 3600.0;
+        const double dx = x - meanX;
+        meanX += dx / trendCount;
+        meanY += (value - meanY) / trendCount;
+        m2X += dx * (x - meanX);
+        coXY += dx * (value - meanY);
+    }
+
+    /**
+     * @brief Zwraca wariancję z próby
+     * @return Wariancja (NAN gdy mniej niż dwie wartości)
+     */
+    double variance() const { return count > 1 ? m2 / (count - 1) : NAN; }
+
+    /**
+     * @brief Zwraca współczynnik kierunkowy regresji liniowej
+     * @return Zmiana wartości na godzinę (NAN gdy trend nieokreślony)
+     */
+    double slopePerHour() const { return trendCount > 1 && m2X > 0 ? coXY / m2X : NAN; }
+};
@@ -0,0 +1,162 @@
+#include "SeriesFrame.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+qint64 floorToStep(qint64 time) {
+    const qint64 step = SeriesFrame::Step;
+    return (time >= 0 ? time / step : (time - step + 1) / step) * step;
+}
+
+bool usable(const Measurement &series, int i) {
+    return series.isValidAt(i) && series.times()[i] != Measurement::InvalidTime &&
+           !std::isnan(series.values()[i]);
+}
+
+//akumulator korelacji pary kolumn (współmoment metodą Welforda)
+struct PairAccumulator {
+    qint64 n = 0;
+    double meanA = 0, meanB = 0;
+    double m2A = 0, m2B = 0, co = 0;
+
+    void add(double a, double b) {
+        ++n;
+        const double da = a - meanA;
+        meanA += da / n;
+        const double db = b - meanB;
+        meanB += db / n;
+        m2A += da * (a - meanA);
+        m2B += db * (b - meanB);
+        co += da * (b - meanB);
+    }
+
+    double correlation() const {
+        return n > 1 && m2A > 0 && m2B > 0 ? co / std::sqrt(m2A * m2B) : NAN;
+    }
+};
+
+}
+
+SeriesFrame SeriesFrame::align(const QVector<Measurement> &series) {
+    SeriesFrame frame;
+
+    //zakres siatki - od najstarszej do najnowszej pełnej godziny
+    qint64 first = std::numeric_limits<qint64>::max();
+    qint64 last = std::numeric_limits<qint64>::min();
+    for (const Measurement &measurement : series) {
+        for (int i = 0; i < measurement.size(); ++i) {
+            if (!usable(measurement, i)) continue;
+            const qint64 hour = floorToStep(measurement.times()[i]);
+            first = std::min(first, hour);
+            last = std::max(last, hour);
+        }
+    }
+
+    for (const Measurement &measurement : series) {
+        frame.m_labels << measurement.paramCode();
+    }
+    if (first > last) {
+        frame.m_columns.resize(series.size());
+        return frame;
+    }
+
+    frame.m_start = first;
+    frame.m_rows = int((last - first) / Step) + 1;
+    frame.m_columns.reserve(series.size());
+
+    QVector<float> sums(frame.m_rows);
+    QVector<int> counts(frame.m_rows);
+    for (const Measurement &measurement : series) {
+        sums.fill(0);
+        counts.fill(0);
+        for (int i = 0; i < measurement.size(); ++i) {
+            if (!usable(measurement, i)) continue;
+            const int row = int((floorToStep(measurement.times()[i]) - first) / Step);
+            sums[row] += measurement.values()[i];
+            counts[row]++;
+        }
+
+        QVector<float> column(frame.m_rows);
+        for (int row = 0; row < frame.m_rows; ++row) {
+            column[row] = counts[row] > 0 ? sums[row] / counts[row] : NAN;
+        }
+        frame.m_columns.append(column);
+    }
+
+    return frame;
+}
+
+void SeriesFrame::interpolateGaps(int maxGapHours) {
+    for (QVector<float> &column : m_columns) {
+        int previous = -1; //ostatni wiersz z wartością
+        for (int row = 0; row < m_rows; ++row) {
+            if (std::isnan(column[row])) continue;
+
+            const int gap = row - previous - 1;
+            if (previous >= 0 && gap > 0 && gap <= maxGapHours) {
+                const float from = column[previous];
+                const float step = (column[row] - from) / (gap + 1);
+                for (int k = 1; k <= gap; ++k) {
+                    column[previous + k] = from + step * k;
+                }
+            }
+            previous = row;
+        }
+    }
+}
+
+QVector<float> SeriesFrame::ratio(int numerator, int denominator) const {
+    const QVector<float> &top = m_columns[numerator];
+    const QVector<float> &bottom = m_columns[denominator];
+
+    QVector<float> result(m_rows);
+    for (int row = 0; row < m_rows; ++row) {
+        //NAN w liczniku przechodzi przez dzielenie, mianownik sprawdzamy jawnie
+        result[row] = bottom[row] > 0 ? top[row] / bottom[row] : NAN;
+    }
+    return result;
+}
+
+double SeriesFrame::correlation(int a, int b) const {
+    const QVector<float> &first = m_columns[a];
+    const QVector<float> &second = m_columns[b];
+
+    PairAccumulator accumulator;
+    for (int row = 0; row < m_rows; ++row) {
+        if (!std::isnan(first[row]) && !std::isnan(second[row])) {
+            accumulator.add(first[row], second[row]);
+        }
+    }
+    return accumulator.correlation();
+}
+
+QVector<QVector<double>> SeriesFrame::correlationMatrix() const {
+    const int n = columns();
+    QVector<PairAccumulator> pairs(n * n);
+
+    //jedno przejście po wierszach, w każdym wierszu wszystkie pary z danymi
+    QVector<int> present;
+    present.reserve(n);
+    for (int row = 0; row < m_rows; ++row) {
+        present.clear();
+        for (int c = 0; c < n; ++c) {
+            if (!std::isnan(m_columns[c][row])) present.append(c);
+        }
+        for (int i = 0; i < present.size(); ++i) {
+            for (int j = i + 1; j < present.size(); ++j) {
+                pairs[present[i] * n + present[j]].add(m_columns[present[i]][row], m_columns[present[j]][row]);
+            }
+        }
+    }
+
+    QVector<QVector<double>> matrix(n, QVector<double>(n, NAN));
+    for (int i = 0; i < n; ++i) {
+        matrix[i][i] = 1;
+        for (int j = i + 1; j < n; ++j) {
+            matrix[i][j] = matrix[j][i] = pairs[i * n + j].correlation();
+        }
+    }
+    return matrix;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "Measurement.h"
+
+/**
+ * @file seriesframe.h
+ * @brief Definicja klasy SeriesFrame - serii wielu czujników na wspólnej siatce godzinowej
+ */
+
+/**
+ * @class SeriesFrame
+ * @brief Kolumnowa ramka wielu serii pomiarów wyrównanych do pełnych godzin
+ *
+ * Każda seria staje się kolumną float o tej samej liczbie wierszy, a brak pomiaru
+ * jest zapisany jako NAN. Wiersze są uporządkowane od najstarszej godziny, więc
+ * korelacje, ilorazy i wykresy wielu serii liczy się jednym przejściem po kolumnach.
+ * @ingroup DataModels
+ */
+class SeriesFrame {
+public:
+    static constexpr qint64 Step = 3600; ///< Krok siatki w sekundach
+
+    /**
+     * @brief Wyrównuje serie do wspólnej siatki godzinowej
+     * @param series Serie pomiarów (etykietą kolumny jest kod parametru)
+     * @return Ramka obejmująca godziny od najstarszego do najnowszego pomiaru
+     * @note Kilka pomiarów w tej samej godzinie jest uśrednianych
+     */
+    static SeriesFrame align(const QVector<Measurement> &series);
+
+    int rows() const { return m_rows; } ///< Liczba godzin w siatce
+    int columns() const { return m_columns.size(); } ///< Liczba serii
+    bool isEmpty() const { return m_rows == 0; } ///< Czy ramka nie ma wierszy
+    qint64 timeAt(int row) const { return m_start + row * Step; } ///< Czas wiersza w sekundach od epoki
+    const QVector<float>& column(int index) const { return m_columns[index]; } ///< Kolumna wartości (NAN - brak)
+    QString label(int index) const { return m_labels[index]; } ///< Etykieta kolumny
+    int indexOf(const QString &label) const { return m_labels.indexOf(label); } ///< Indeks kolumny (-1 gdy brak)
+
+    /**
+     * @brief Uzupełnia krótkie luki interpolacją liniową
+     * @param maxGapHours Najdłuższa uzupełniana luka (w godzinach)
+     */
+    void interpolateGaps(int maxGapHours);
+
+    /**
+     * @brief Liczy iloraz dwóch kolumn wiersz po wierszu
+     * @param numerator Indeks kolumny licznika
+     * @param denominator Indeks kolumny mianownika
+     * @return Kolumna ilorazów (NAN gdy brak danych lub mianownik niedodatni)
+     */
+    QVector<float> ratio(int numerator, int denominator) const;
+
+    /**
+     * @brief Liczy współczynnik korelacji Pearsona dwóch kolumn
+     * @param a Indeks pierwszej kolumny
+     * @param b Indeks drugiej kolumny
+     * @return Korelacja z wierszy, w których obie kolumny mają wartości (NAN gdy za mało)
+     */
+    double correlation(int a, int b) const;
+
+    /**
+     * @brief Liczy korelacje wszystkich par kolumn jednym przejściem po wierszach
+     * @return Macierz columns() x columns() (na przekątnej 1 lub NAN)
+     */
+    QVector<QVector<double>> correlationMatrix() const;
+
+private:
+    qint64 m_start = 0;                  ///< Czas pierwszego wiersza (pełna godzina)
+    int m_rows = 0;                      ///< Liczba wierszy
+    QStringList m_labels;                ///< Etykiety kolumn
+    QVector<QVector<float>> m_columns;   ///< Kolumny wartości
+};
@@ -0,0 +1,228 @@
+#include "SeriesStatistics.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr int WordSize = 64;  //punkty na słowo bitmapy poprawności
+constexpr int Lanes = 8;      //niezależne tory akumulatorów - kompilator łączy je w rejestry wektorowe
+
+//bajt bitmapy rozpisany na 8 bajtów 0/1 (bit k -> bajt k)
+constexpr std::array<quint64, 256> makeByteMasks() {
+    std::array<quint64, 256> masks{};
+    for (int byte = 0; byte < 256; ++byte) {
+        quint64 mask = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (byte & (1 << bit)) mask |= quint64(1) << (bit * 8);
+        }
+        masks[byte] = mask;
+    }
+    return masks;
+}
+constexpr std::array<quint64, 256> ByteMasks = makeByteMasks();
+
+//słowo bitmapy jako 64 bajty 0/1 - maska dla pętli bez rozgałęzień
+void expandWord(quint64 bits, quint8 *mask) {
+    for (int byte = 0; byte < 8; ++byte) {
+        const quint64 expanded = ByteMasks[(bits >> (byte * 8)) & 0xFF];
+        std::memcpy(mask + byte * 8, &expanded, sizeof(expanded));
+    }
+}
+
+//kolumny jednego słowa po nałożeniu maski - wejście pętli akumulującej
+struct WordColumns {
+    float value[WordSize];  //wartość albo punkt odniesienia - zero w sumach, bez wpływu na min/max
+    float used[WordSize];   //1 dla poprawnej wartości
+    float timed[WordSize];  //1 dla poprawnej wartości ze znanym czasem
+    qint32 offsetHigh[WordSize];  //sekundy od czasu odniesienia: starsze 32 bity, 0 poza maską
+    qint32 offsetLow[WordSize];   //młodsze 32 bity przesunięte o 2^31 (liczba ze znakiem)
+};
+
+/**
+ * Sumy częściowe w osobnych torach. Każdy tor sumuje swoje punkty w stałej kolejności,
+ * więc wynik nie zależy od tego, czy kompilator użył instrukcji wektorowych.
+ */
+struct Accumulators {
+    double count[Lanes] = {};
+    double sumD[Lanes] = {};
+    double sumD2[Lanes] = {};
+    float low[Lanes];
+    float high[Lanes];
+
+    double trendCount[Lanes] = {};
+    double sumX[Lanes] = {};
+    double sumY[Lanes] = {};
+    double sumXY[Lanes] = {};
+    double sumX2[Lanes] = {};
+
+    Accumulators() {
+        std::fill(std::begin(low), std::end(low), std::numeric_limits<float>::infinity());
+        std::fill(std::begin(high), std::end(high), -std::numeric_limits<float>::infinity());
+    }
+};
+
+//maska wartości: same wybory i porównania, żadnej arytmetyki pod warunkiem -
+//bez -ffast-math gcc nie zamienia warunkowych operacji zmiennoprzecinkowych na wektorowe
+void maskValues(const float *values, const quint8 *mask, float valueOrigin, WordColumns &word) {
+    for (int i = 0; i < WordSize; ++i) {
+        const float value = values[i];
+        const bool use = (mask[i] != 0) & (value == value);
+        word.value[i] = use ? value : valueOrigin;
+        word.used[i] = use ? 1.0f : 0.0f;
+    }
+}
+
+//maska czasów: InvalidTime sprawdzany na połówkach 32-bitowych - SSE2 nie ma
+//porównania 64-bitowego i pętla zostałaby skalarna
+void maskTimes(const qint64 *times, qint64 timeOrigin, WordColumns &word) {
+    for (int i = 0; i < WordSize; ++i) {
+        const qint64 time = times[i];
+        const bool invalid = (qint32(quint64(time) >> 32) == qint32(0x80000000u)) & (quint32(time) == 0);
+        const bool timed = (word.used[i] != 0.0f) & !invalid;
+        //przesunięcie rozbite na dwie połówki 32-bitowe - konwersja int32 -> double jest wektorowa
+        const quint64 offset = timed ? quint64(time) - quint64(timeOrigin) : 0;
+        word.offsetHigh[i] = qint32(offset >> 32);
+        word.offsetLow[i] = qint32(quint32(offset) ^ 0x80000000u);
+        word.timed[i] = timed ? 1.0f : 0.0f;
+    }
+}
+
+//sumy po torach: czysta arytmetyka na zamaskowanych kolumnach
+void accumulateWord(const WordColumns &word, float valueOrigin, Accumulators &acc) {
+    const double origin = valueOrigin;
+    for (int k = 0; k < WordSize; k += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const int i = k + l;
+            const double d = double(word.value[i]) - origin;
+            const double t = word.timed[i];
+            const double seconds = double(word.offsetHigh[i]) * 4294967296.0
+                                   + (double(word.offsetLow[i]) + 2147483648.0);
+            const double x = seconds * (1.0 / 3600.0);
+
+            acc.count[l] += word.used[i];
+            acc.sumD[l] += d;
+            acc.sumD2[l] += d * d;
+            acc.low[l] = word.value[i] < acc.low[l] ? word.value[i] : acc.low[l];
+            acc.high[l] = word.value[i] > acc.high[l] ? word.value[i] : acc.high[l];
+
+            acc.trendCount[l] += t;
+            acc.sumX[l] += x;
+            acc.sumY[l] += d * t;
+            acc.sumXY[l] += x * d;
+            acc.sumX2[l] += x * x;
+        }
+    }
+}
+
+double laneSum(const double *lanes) {
+    double sum = 0;
+    for (int l = 0; l < Lanes; ++l) sum += lanes[l];
+    return sum;
+}
+
+bool isValid(const quint64 *validBits, int i) {
+    return (validBits[i >> 6] >> (i & 63)) & 1u;
+}
+
+}
+
+SeriesStatistics SeriesStatistics::compute(const Measurement::View &view) {
+    const Measurement *series = view.series();
+    if (!series || view.isEmpty()) {
+        return SeriesStatistics();
+    }
+    return compute(series->times().constData(), series->values().constData(),
+                   series->validBits().constData(), view.firstIndex(), view.endIndex());
+}
+
+SeriesStatistics SeriesStatistics::compute(const qint64 *times, const float *values,
+                                           const quint64 *validBits, int begin, int end) {
+    SeriesStatistics stats;
+
+    //punkty odniesienia: pierwsza poprawna wartość i pierwszy znany czas -
+    //mniejsze liczby w sumach, mniejsze błędy zaokrągleń
+    int first = begin;
+    while (first < end && (!isValid(validBits, first) || std::isnan(values[first]))) ++first;
+    if (first == end) {
+        return stats;
+    }
+    const float valueOrigin = values[first];
+
+    qint64 timeOrigin = 0;
+    for (int i = begin; i < end; ++i) {
+        if (times[i] != Measurement::InvalidTime) {
+            timeOrigin = times[i];
+            break;
+        }
+    }
+
+    //przebieg 1: słowo po słowie maska, potem sumy; brzegowe słowa przez bufor uzupełniony zerami
+    Accumulators acc;
+    WordColumns columns;
+    quint8 mask[WordSize];
+    float edgeValues[WordSize];
+    qint64 edgeTimes[WordSize];
+
+    for (int word = first >> 6; word <= (end - 1) >> 6; ++word) {
+        const int wordBegin = word << 6;
+        const int from = std::max(first, wordBegin);
+        const int to = std::min(end, wordBegin + WordSize);
+
+        quint64 bits = validBits[word];
+        if (from > wordBegin) bits &= ~quint64(0) << (from - wordBegin);
+        if (to < wordBegin + WordSize) bits &= ~(~quint64(0) << (to - wordBegin));
+        if (bits == 0) continue; //całe słowo bez poprawnych punktów
+
+        const float *wordValues = values + wordBegin;
+        const qint64 *wordTimes = times + wordBegin;
+        if (from > wordBegin || to < wordBegin + WordSize) {
+            std::fill(std::begin(edgeValues), std::end(edgeValues), 0.0f);
+            std::fill(std::begin(edgeTimes), std::end(edgeTimes), Measurement::InvalidTime);
+            std::copy(values + from, values + to, edgeValues + (from - wordBegin));
+            std::copy(times + from, times + to, edgeTimes + (from - wordBegin));
+            wordValues = edgeValues;
+            wordTimes = edgeTimes;
+        }
+
+        expandWord(bits, mask);
+        maskValues(wordValues, mask, valueOrigin, columns);
+        maskTimes(wordTimes, timeOrigin, columns);
+        accumulateWord(columns, valueOrigin, acc);
+    }
+
+    const int count = int(laneSum(acc.count));
+    const double sumD = laneSum(acc.sumD);
+    const double sumD2 = laneSum(acc.sumD2);
+    const float minValue = *std::min_element(std::begin(acc.low), std::end(acc.low));
+    const float maxValue = *std::max_element(std::begin(acc.high), std::end(acc.high));
+
+    //przebieg 2: pierwsze wystąpienia minimum i maksimum (zwykle blisko początku)
+    int minIndex = -1, maxIndex = -1;
+    for (int i = first; i < end && (minIndex < 0 || maxIndex < 0); ++i) {
+        if (!isValid(validBits, i)) continue;
+        if (minIndex < 0 && values[i] == minValue) minIndex = i;
+        if (maxIndex < 0 && values[i] == maxValue) maxIndex = i;
+    }
+
+    stats.count = count;
+    stats.trendCount = int(laneSum(acc.trendCount));
+    stats.min = minValue;
+    stats.max = maxValue;
+    stats.argMin = minIndex - begin;
+    stats.argMax = maxIndex - begin;
+    stats.mean = valueOrigin + sumD / count;
+    if (count > 1) {
+        stats.variance = std::max(0.0, (sumD2 - sumD * sumD / count) / (count - 1));
+    }
+
+    const int n = stats.trendCount;
+    const double sumX = laneSum(acc.sumX);
+    const double sumY = laneSum(acc.sumY);
+    const double denominator = n * laneSum(acc.sumX2) - sumX * sumX;
+    if (n > 1 && denominator != 0) {
+        stats.slopePerHour = (n * laneSum(acc.sumXY) - sumX * sumY) / denominator;
+    }
+    return stats;
+}
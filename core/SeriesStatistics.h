@@ -0,0 +1,58 @@
+#pragma once
+#include <QtGlobal>
+#include <cmath>
+#include "Measurement.h"
+
+/**
+ * @file seriesstatistics.h
+ * @brief Definicja struktury SeriesStatistics - jądra statystyk serii bez rozgałęzień
+ */
+
+/**
+ * @struct SeriesStatistics
+ * @brief Statystyki opisowe fragmentu serii pomiarów
+ *
+ * Pierwszy przebieg idzie słowami bitmapy poprawności: słowo jest rozpisywane na maskę,
+ * a sumy, minimum i maksimum liczone są bez skoków zależnych od danych w niezależnych
+ * torach (pętle wektoryzowane przez kompilator, sprawdzone -fopt-info-vec). Drugi,
+ * krótki przebieg szuka pierwszych wystąpień minimum i maksimum. Słowa bez poprawnych
+ * punktów są pomijane w całości, a sumy są liczone względem pierwszego punktu,
+ * co ogranicza utratę precyzji przy dużych znacznikach czasu.
+ * @ingroup DataModels
+ */
+struct SeriesStatistics {
+    int count = 0;              ///< Liczba poprawnych wartości
+    double min = NAN;           ///< Minimalna wartość
+    double max = NAN;           ///< Maksymalna wartość
+    int argMin = -1;            ///< Indeks minimum w widoku (-1 gdy brak)
+    int argMax = -1;            ///< Indeks maksimum w widoku (-1 gdy brak)
+    double mean = NAN;          ///< Średnia wartość
+    double variance = NAN;      ///< Wariancja z próby (wymaga co najmniej dwóch wartości)
+    int trendCount = 0;         ///< Liczba punktów z czasem użytych w regresji
+    double slopePerHour = NAN;  ///< Współczynnik kierunkowy regresji liniowej (jednostka/h)
+
+    /**
+     * @brief Liczy statystyki dla widoku serii
+     * @param view Widok na analizowane punkty
+     * @return Wypełniona struktura SeriesStatistics
+     */
+    static SeriesStatistics compute(const Measurement::View &view);
+
+    /**
+     * @brief Liczy statystyki bezpośrednio na kolumnach
+     * @param times Kolumna czasów (sekundy od epoki, Measurement::InvalidTime gdy brak)
+     * @param values Kolumna wartości
+     * @param validBits Bitmapa poprawności całej serii
+     * @param begin Indeks pierwszego punktu
+     * @param end Indeks za ostatnim punktem
+     * @return Wypełniona struktura SeriesStatistics (indeksy względem begin)
+     */
+    static SeriesStatistics compute(const qint64 *times, const float *values,
+                                    const quint64 *validBits, int begin, int end);
+
+    /**
+     * @brief Zwraca odchylenie standardowe
+     * @return Pierwiastek z wariancji (NAN gdy niedostępna)
+     */
+    double stdDev() const { return std::sqrt(variance); }
+};
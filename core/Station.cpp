@@ -1,4 +1,5 @@
 #include "Station.h"
+#include "StationDistances.h"
 #include <QDebug>
 #include <QtMath>
 
@@ -83,8 +84,7 @@ QString Station::toFullString(double refLat, double refLon) const {
 }
 
 QString Station::distanceStringTo(double lat, double lon) const {
-    double dist = distanceTo(lat, lon);
-    return QString("%1 km").arg(dist, 0, 'f', 2);
+    return StationDistances::format(distanceTo(lat, lon));
 }
 
 //json
@@ -0,0 +1,72 @@
+#include "StationDistances.h"
+#include <QtMath>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+constexpr double EarthRadiusKm = 6371.0;
+
+}
+
+StationDistances::StationDistances(const QVector<Station> &stations) {
+    const int n = stations.size();
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+
+    //cos(szerokości) i pozostałe funkcje liczone raz na stację
+    for (int i = 0; i < n; ++i) {
+        const double lat = qDegreesToRadians(stations[i].latitude());
+        const double lon = qDegreesToRadians(stations[i].longitude());
+        m_x[i] = std::cos(lat) * std::cos(lon);
+        m_y[i] = std::cos(lat) * std::sin(lon);
+        m_z[i] = std::sin(lat);
+    }
+}
+
+void StationDistances::chordsSquared(double lat, double lon, double *out) const {
+    const double latRad = qDegreesToRadians(lat);
+    const double lonRad = qDegreesToRadians(lon);
+    const double qx = std::cos(latRad) * std::cos(lonRad);
+    const double qy = std::cos(latRad) * std::sin(lonRad);
+    const double qz = std::sin(latRad);
+
+    //różnice zamiast iloczynu skalarnego - bez utraty precyzji dla małych odległości
+    const double *x = m_x.constData();
+    const double *y = m_y.constData();
+    const double *z = m_z.constData();
+    const int n = size();
+    for (int i = 0; i < n; ++i) {
+        const double dx = x[i] - qx;
+        const double dy = y[i] - qy;
+        const double dz = z[i] - qz;
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+QVector<double> StationDistances::distancesTo(double lat, double lon) const {
+    QVector<double> km(size());
+    double *out = km.data();
+    chordsSquared(lat, lon, out);
+
+    //cięciwa c = 2 sin(d / 2R), więc d = 2R asin(c / 2)
+    for (int i = 0; i < km.size(); ++i) {
+        out[i] = 2 * EarthRadiusKm * std::asin(std::min(1.0, std::sqrt(out[i]) / 2));
+    }
+    return km;
+}
+
+QVector<int> StationDistances::orderByDistance(double lat, double lon) const {
+    QVector<double> chords(size());
+    chordsSquared(lat, lon, chords.data());
+
+    QVector<int> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&chords](int a, int b) { return chords[a] < chords[b]; });
+    return order;
+}
+
+QString StationDistances::format(double km) {
+    return QString("%1 km").arg(km, 0, 'f', 2);
+}
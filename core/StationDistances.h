@@ -0,0 +1,62 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include "Station.h"
+
+/**
+ * @file stationdistances.h
+ * @brief Definicja klasy StationDistances - wsadowego liczenia odległości do stacji
+ */
+
+/**
+ * @class StationDistances
+ * @brief Odległości od jednego punktu do wielu stacji w jednym wywołaniu
+ *
+ * Współrzędne stacji są zamieniane raz na wektory jednostkowe (x, y, z) trzymane
+ * w osobnych ciągłych tablicach. Długość cięciwy do punktu zapytania wymaga wtedy
+ * tylko mnożeń i dodawań, więc pętla jest wektoryzowana przez kompilator (SIMD),
+ * a funkcja trygonometryczna (asin) jest liczona tylko przy zamianie na kilometry.
+ * Kolejność według cięciwy jest taka sama jak według odległości po sferze.
+ */
+class StationDistances {
+public:
+    StationDistances() = default;
+
+    /**
+     * @brief Konstruktor przygotowujący współrzędne stacji
+     * @param stations Stacje (indeksy wyników odpowiadają indeksom w tym wektorze)
+     */
+    explicit StationDistances(const QVector<Station> &stations);
+
+    int size() const { return m_x.size(); } ///< Liczba stacji
+
+    /**
+     * @brief Liczy odległości do wszystkich stacji
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @return Odległości w kilometrach (haversine, jak Station::distanceTo)
+     */
+    QVector<double> distancesTo(double lat, double lon) const;
+
+    /**
+     * @brief Porządkuje stacje według odległości bez liczenia kilometrów
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @return Indeksy stacji od najbliższej
+     */
+    QVector<int> orderByDistance(double lat, double lon) const;
+
+    /**
+     * @brief Formatuje odległość do wyświetlenia
+     * @param km Odległość w kilometrach
+     * @return String w formacie "X.XX km"
+     */
+    static QString format(double km);
+
+private:
+    QVector<double> m_x; ///< Składowa x wektorów jednostkowych stacji
+    QVector<double> m_y; ///< Składowa y wektorów jednostkowych stacji
+    QVector<double> m_z; ///< Składowa z wektorów jednostkowych stacji
+
+    void chordsSquared(double lat, double lon, double *out) const;
+};
@@ -0,0 +1,202 @@
+#include "StationIndex.h"
+#include <QtMath>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+bool closer(const StationIndex::Hit &a, const StationIndex::Hit &b) {
+    return a.distanceKm < b.distanceKm;
+}
+
+}
+
+//punkt zapytania z wartościami trygonometrycznymi policzonymi raz
+struct StationIndex::Query {
+    double lat, lon, cosLat;
+    double minLat, maxLat, minLon, maxLon; //prostokąt otaczający koło (tylko zapytanie o promień)
+    double radiusKm;
+};
+
+void StationIndex::build(const QVector<Station> &stations) {
+    const int n = stations.size();
+    m_lat.resize(n);
+    m_lon.resize(n);
+    m_cosLat.resize(n);
+    m_station.resize(n);
+    m_axis.fill(0, n);
+
+    for (int i = 0; i < n; ++i) {
+        m_lat[i] = qDegreesToRadians(stations[i].latitude());
+        m_lon[i] = qDegreesToRadians(stations[i].longitude());
+        m_station[i] = i;
+    }
+    buildRange(0, n);
+
+    for (int i = 0; i < n; ++i) {
+        m_cosLat[i] = std::cos(m_lat[i]);
+    }
+}
+
+void StationIndex::buildRange(int begin, int end) {
+    if (end - begin <= 1) return;
+
+    //oś o większym rozrzucie (długość skalowana do km w środku zakresu)
+    const auto [minLat, maxLat] = std::minmax_element(m_lat.cbegin() + begin, m_lat.cbegin() + end);
+    const auto [minLon, maxLon] = std::minmax_element(m_lon.cbegin() + begin, m_lon.cbegin() + end);
+    const double latSpread = *maxLat - *minLat;
+    const double lonSpread = (*maxLon - *minLon) * std::cos((*maxLat + *minLat) / 2);
+    const quint8 axis = lonSpread > latSpread ? 1 : 0;
+    const QVector<double> &key = axis == 0 ? m_lat : m_lon;
+
+    //mediana na pozycji mid, permutacja przestawia wszystkie kolumny naraz
+    const int mid = begin + (end - begin) / 2;
+    QVector<int> order(end - begin);
+    std::iota(order.begin(), order.end(), begin);
+    std::nth_element(order.begin(), order.begin() + (mid - begin), order.end(),
+                     [&key](int a, int b) { return key[a] < key[b]; });
+
+    QVector<double> lat(order.size()), lon(order.size());
+    QVector<int> station(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        lat[i] = m_lat[order[i]];
+        lon[i] = m_lon[order[i]];
+        station[i] = m_station[order[i]];
+    }
+    std::copy(lat.cbegin(), lat.cend(), m_lat.begin() + begin);
+    std::copy(lon.cbegin(), lon.cend(), m_lon.begin() + begin);
+    std::copy(station.cbegin(), station.cend(), m_station.begin() + begin);
+    m_axis[mid] = axis;
+
+    buildRange(begin, mid);
+    buildRange(mid + 1, end);
+}
+
+double StationIndex::distance(int node, const Query &query) const {
+    //haversine z cosinusami policzonymi przy budowie i w zapytaniu
+    const double sinLat = std::sin((m_lat[node] - query.lat) / 2);
+    const double sinLon = std::sin((m_lon[node] - query.lon) / 2);
+    const double a = sinLat * sinLat + query.cosLat * m_cosLat[node] * sinLon * sinLon;
+    return 2 * EarthRadiusKm * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+QVector<StationIndex::Hit> StationIndex::withinRadius(double lat, double lon, double radiusKm) const {
+    QVector<Hit> hits;
+    if (isEmpty() || radiusKm < 0) return hits;
+
+    Query query;
+    query.lat = qDegreesToRadians(lat);
+    query.lon = qDegreesToRadians(lon);
+    query.cosLat = std::cos(query.lat);
+    query.radiusKm = radiusKm;
+
+    //prostokąt otaczający koło na sferze - zakres długości zależy od szerokości
+    const double angular = radiusKm / EarthRadiusKm;
+    query.minLat = query.lat - angular;
+    query.maxLat = query.lat + angular;
+    const double sinAngular = std::sin(std::min(angular, M_PI / 2));
+    if (query.minLat > -M_PI / 2 && query.maxLat < M_PI / 2 && sinAngular < query.cosLat) {
+        const double deltaLon = std::asin(sinAngular / query.cosLat);
+        query.minLon = query.lon - deltaLon;
+        query.maxLon = query.lon + deltaLon;
+    } else {
+        query.minLon = -M_PI;
+        query.maxLon = M_PI;
+    }
+    //koło przecinające południk 180° - bez ograniczenia długości
+    if (query.minLon < -M_PI || query.maxLon > M_PI) {
+        query.minLon = -M_PI;
+        query.maxLon = M_PI;
+    }
+
+    searchRadius(0, size(), query, hits);
+    std::sort(hits.begin(), hits.end(), closer);
+    return hits;
+}
+
+void StationIndex::searchRadius(int begin, int end, const Query &query, QVector<Hit> &hits) const {
+    while (begin < end) {
+        const int mid = begin + (end - begin) / 2;
+        const double lat = m_lat[mid];
+        const double lon = m_lon[mid];
+
+        //dokładna odległość tylko dla punktów z prostokąta
+        if (lat >= query.minLat && lat <= query.maxLat && lon >= query.minLon && lon <= query.maxLon) {
+            const double km = distance(mid, query);
+            if (km <= query.radiusKm) hits.append({m_station[mid], km});
+        }
+
+        const double split = m_axis[mid] == 0 ? lat : lon;
+        const double low = m_axis[mid] == 0 ? query.minLat : query.minLon;
+        const double high = m_axis[mid] == 0 ? query.maxLat : query.maxLon;
+        const bool left = low <= split;
+        const bool right = high >= split;
+
+        //jedno poddrzewo w pętli, drugie rekurencyjnie
+        if (left && right) {
+            searchRadius(begin, mid, query, hits);
+            begin = mid + 1;
+        } else if (left) {
+            end = mid;
+        } else if (right) {
+            begin = mid + 1;
+        } else {
+            return;
+        }
+    }
+}
+
+QVector<StationIndex::Hit> StationIndex::nearest(double lat, double lon, int k) const {
+    QVector<Hit> heap;
+    if (isEmpty() || k <= 0) return heap;
+
+    Query query;
+    query.lat = qDegreesToRadians(lat);
+    query.lon = qDegreesToRadians(lon);
+    query.cosLat = std::cos(query.lat);
+
+    heap.reserve(k + 1);
+    searchNearest(0, size(), query, k, heap);
+    std::sort_heap(heap.begin(), heap.end(), closer);
+    return heap;
+}
+
+void StationIndex::searchNearest(int begin, int end, const Query &query, int k, QVector<Hit> &heap) const {
+    if (begin >= end) return;
+    const int mid = begin + (end - begin) / 2;
+
+    //kopiec maksymalny - na szczycie najdalszy z dotychczas najbliższych
+    const double km = distance(mid, query);
+    if (heap.size() < k || km < heap.front().distanceKm) {
+        heap.append({m_station[mid], km});
+        std::push_heap(heap.begin(), heap.end(), closer);
+        if (heap.size() > k) {
+            std::pop_heap(heap.begin(), heap.end(), closer);
+            heap.removeLast();
+        }
+    }
+
+    //dolne ograniczenie odległości do punktów po drugiej stronie podziału
+    double bound;
+    bool leftFirst;
+    if (m_axis[mid] == 0) {
+        const double delta = query.lat - m_lat[mid];
+        leftFirst = delta <= 0;
+        bound = EarthRadiusKm * std::abs(delta);
+    } else {
+        const double delta = query.lon - m_lon[mid];
+        leftFirst = delta <= 0;
+        //druga strona sięga od południka podziału do południka 180° - bliższa z granic
+        const double gap = std::min(std::abs(delta), leftFirst ? query.lon + M_PI : M_PI - query.lon);
+        //odległość do południka (dla różnicy długości powyżej 90° bez ograniczenia)
+        bound = gap < M_PI / 2 ? EarthRadiusKm * std::asin(std::min(1.0, query.cosLat * std::sin(gap))) : 0;
+    }
+
+    if (leftFirst) {
+        searchNearest(begin, mid, query, k, heap);
+        if (heap.size() < k || bound < heap.front().distanceKm) searchNearest(mid + 1, end, query, k, heap);
+    } else {
+        searchNearest(mid + 1, end, query, k, heap);
+        if (heap.size() < k || bound < heap.front().distanceKm) searchNearest(begin, mid, query, k, heap);
+    }
+}
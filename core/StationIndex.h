@@ -0,0 +1,82 @@
+#pragma once
+#include <QVector>
+#include "Station.h"
+
+/**
+ * @file stationindex.h
+ * @brief Definicja klasy StationIndex - indeksu przestrzennego stacji
+ */
+
+/**
+ * @class StationIndex
+ * @brief Drzewo k-d po współrzędnych stacji do zapytań o promień i najbliższych sąsiadów
+ *
+ * Drzewo jest zapisane niejawnie w tablicach (węzeł to mediana zakresu), a oś podziału
+ * jest wybierana według większego rozrzutu współrzędnych. Zapytanie o promień obcina
+ * poddrzewa prostokątem szerokości i długości geograficznej otaczającym koło, a dokładny
+ * haversine liczy tylko dla kandydatów z prostokąta. Zapytanie k-NN odrzuca poddrzewa
+ * na podstawie dolnego ograniczenia odległości do płaszczyzny podziału.
+ */
+class StationIndex {
+public:
+    static constexpr double EarthRadiusKm = 6371.0; ///< Promień Ziemi (jak w Station::distanceTo)
+
+    /**
+     * @struct Hit
+     * @brief Wynik zapytania
+     */
+    struct Hit {
+        int index;          ///< Indeks stacji w wektorze przekazanym do build()
+        double distanceKm;  ///< Odległość od punktu zapytania w kilometrach
+    };
+
+    StationIndex() = default;
+
+    /**
+     * @brief Konstruktor budujący indeks
+     * @param stations Stacje do zaindeksowania
+     */
+    explicit StationIndex(const QVector<Station> &stations) { build(stations); }
+
+    /**
+     * @brief Buduje indeks od nowa (koszt O(n log n))
+     * @param stations Stacje do zaindeksowania
+     */
+    void build(const QVector<Station> &stations);
+
+    int size() const { return m_station.size(); } ///< Liczba zaindeksowanych stacji
+    bool isEmpty() const { return m_station.isEmpty(); } ///< Czy indeks jest pusty
+
+    /**
+     * @brief Znajduje stacje w podanym promieniu
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @param radiusKm Promień w kilometrach
+     * @return Trafienia uporządkowane od najbliższego
+     */
+    QVector<Hit> withinRadius(double lat, double lon, double radiusKm) const;
+
+    /**
+     * @brief Znajduje k najbliższych stacji
+     * @param lat Szerokość geograficzna punktu
+     * @param lon Długość geograficzna punktu
+     * @param k Liczba szukanych stacji
+     * @return Trafienia uporządkowane od najbliższego (mniej niż k, gdy indeks jest mniejszy)
+     */
+    QVector<Hit> nearest(double lat, double lon, int k) const;
+
+private:
+    struct Query;
+
+    //węzły w kolejności drzewa (mediana zakresu [begin, end) to jego korzeń)
+    QVector<double> m_lat;      ///< Szerokość geograficzna węzła w radianach
+    QVector<double> m_lon;      ///< Długość geograficzna węzła w radianach
+    QVector<double> m_cosLat;   ///< Cosinus szerokości (do haversine)
+    QVector<int> m_station;     ///< Indeks stacji węzła
+    QVector<quint8> m_axis;     ///< Oś podziału węzła (0 - szerokość, 1 - długość)
+
+    void buildRange(int begin, int end);
+    void searchRadius(int begin, int end, const Query &query, QVector<Hit> &hits) const;
+    void searchNearest(int begin, int end, const Query &query, int k, QVector<Hit> &heap) const;
+    double distance(int node, const Query &query) const;
+};
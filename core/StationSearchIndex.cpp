@@ -0,0 +1,201 @@
+#include "StationSearchIndex.h"
+#include <QMap>
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+
+namespace {
+
+//wagi pól stacji
+constexpr float NameWeight = 1.0f;
+constexpr float CityWeight = 1.0f;
+constexpr float StreetWeight = 0.7f;
+constexpr float CommuneWeight = 0.6f;
+constexpr float DistrictWeight = 0.6f;
+constexpr float ProvinceWeight = 0.4f;
+
+//wagi rodzaju dopasowania słowa
+constexpr float ExactScore = 1.0f;
+constexpr float PrefixScore = 0.8f;
+constexpr float FuzzyScore = 0.5f;
+
+QStringList trigrams(const QString &word) {
+    //spacje na brzegach - początek i koniec słowa też tworzą trigramy
+    const QString padded = QChar(' ') + word + QChar(' ');
+    QStringList result;
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        result << padded.mid(i, 3);
+    }
+    return result;
+}
+
+//odległość edycyjna Levenshteina z przerwaniem po przekroczeniu limitu
+int editDistance(const QString &a, const QString &b, int limit) {
+    if (std::abs(a.size() - b.size()) > limit) return limit + 1;
+
+    QVector<int> previous(b.size() + 1);
+    QVector<int> current(b.size() + 1);
+    std::iota(previous.begin(), previous.end(), 0);
+    for (int i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        int rowMin = current[0];
+        for (int j = 1; j <= b.size(); ++j) {
+            const int substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+            rowMin = std::min(rowMin, current[j]);
+        }
+        if (rowMin > limit) return limit + 1;
+        previous.swap(current);
+    }
+    return previous[b.size()];
+}
+
+}
+
+QString StationSearchIndex::normalize(const QString &text) {
+    //rozkład NFD oddziela znaki diakrytyczne od liter
+    const QString decomposed = text.toLower().normalized(QString::NormalizationForm_D);
+    QString result;
+    result.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) continue;
+        //"ł" nie ma rozkładu kanonicznego
+        result.append(c == QChar(0x0142) ? QChar('l') : c);
+    }
+    return result;
+}
+
+QStringList StationSearchIndex::tokenize(const QString &text) {
+    const QString normalized = normalize(text);
+    QStringList words;
+    int start = -1;
+    for (int i = 0; i <= normalized.size(); ++i) {
+        const bool inWord = i < normalized.size() && normalized[i].isLetterOrNumber();
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            words << normalized.mid(start, i - start);
+            start = -1;
+        }
+    }
+    return words;
+}
+
+void StationSearchIndex::build(const QVector<Station> &stations) {
+    //słowo -> (stacja -> waga najważniejszego pola)
+    QMap<QString, QMap<int, float>> words;
+    for (int i = 0; i < stations.size(); ++i) {
+        const Station &station = stations[i];
+        const Station::Address address = station.address();
+        const QPair<QString, float> fields[] = {
+            {station.name(), NameWeight},
+            {address.cityName, CityWeight},
+            {address.streetName, StreetWeight},
+            {address.communeName, CommuneWeight},
+            {address.districtName, DistrictWeight},
+            {address.provinceName, ProvinceWeight}
+        };
+        for (const auto &field : fields) {
+            for (const QString &word : tokenize(field.first)) {
+                float &weight = words[word][i];
+                weight = std::max(weight, field.second);
+            }
+        }
+    }
+
+    m_stationCount = stations.size();
+    m_words.clear();
+    m_postings.clear();
+    m_trigrams.clear();
+    m_words.reserve(words.size());
+    m_postings.reserve(words.size());
+
+    //QMap jest posortowana - słownik gotowy do wyszukiwania binarnego
+    for (auto it = words.cbegin(); it != words.cend(); ++it) {
+        const int id = m_words.size();
+        m_words << it.key();
+
+        QVector<Posting> postings;
+        postings.reserve(it.value().size());
+        for (auto posting = it.value().cbegin(); posting != it.value().cend(); ++posting) {
+            postings.append({posting.key(), posting.value()});
+        }
+        m_postings.append(postings);
+
+        for (const QString &trigram : trigrams(it.key())) {
+            QVector<int> &ids = m_trigrams[trigram];
+            if (ids.isEmpty() || ids.last() != id) ids.append(id);
+        }
+    }
+}
+
+void StationSearchIndex::matchWord(const QString &word, QVector<float> &best, QVector<int> &touched) const {
+    auto score = [&](int id, float match) {
+        for (const Posting &posting : m_postings[id]) {
+            const float value = match * posting.weight;
+            if (best[posting.station] == 0) touched.append(posting.station);
+            best[posting.station] = std::max(best[posting.station], value);
+        }
+    };
+
+    //zakres słów zaczynających się od word
+    bool found = false;
+    for (auto it = std::lower_bound(m_words.cbegin(), m_words.cend(), word);
+         it != m_words.cend() && it->startsWith(word); ++it) {
+        score(int(it - m_words.cbegin()), *it == word ? ExactScore : PrefixScore);
+        found = true;
+    }
+    if (found || word.size() < 3) return;
+
+    //literówki: kandydaci ze wspólnymi trigramami, weryfikacja odległością edycyjną
+    const QStringList wordTrigrams = trigrams(word);
+    QHash<int, int> shared;
+    for (const QString &trigram : wordTrigrams) {
+        const auto it = m_trigrams.constFind(trigram);
+        if (it == m_trigrams.constEnd()) continue;
+        for (int id : it.value()) shared[id]++;
+    }
+
+    const int limit = word.size() <= 5 ? 1 : 2;
+    //każda edycja psuje najwyżej 3 trigramy
+    const int minShared = std::max(1, int(wordTrigrams.size()) - 3 * limit);
+    for (auto it = shared.cbegin(); it != shared.cend(); ++it) {
+        if (it.value() < minShared) continue;
+        const QString &candidate = m_words[it.key()];
+        //niedokończone słowo porównujemy także z początkiem kandydata
+        const int distance = std::min(editDistance(word, candidate, limit),
+                                      editDistance(word, candidate.left(word.size()), limit));
+        if (distance <= limit) {
+            score(it.key(), FuzzyScore / (1 + distance));
+        }
+    }
+}
+
+QVector<int> StationSearchIndex::search(const QString &query, int limit) const {
+    const QStringList words = tokenize(query);
+    if (words.isEmpty() || m_stationCount == 0) return {};
+
+    QVector<float> total(m_stationCount, 0);
+    QVector<int> matched(m_stationCount, 0);
+    QVector<float> best(m_stationCount, 0);
+    QVector<int> touched;
+
+    for (const QString &word : words) {
+        touched.clear();
+        matchWord(word, best, touched);
+        for (int station : touched) {
+            total[station] += best[station];
+            matched[station]++;
+            best[station] = 0;
+        }
+    }
+
+    //stacje pasujące do wszystkich słów zapytania
+    QVector<int> result;
+    for (int station = 0; station < m_stationCount; ++station) {
+        if (matched[station] == words.size()) result.append(station);
+    }
+    std::stable_sort(result.begin(), result.end(), [&total](int a, int b) { return total[a] > total[b]; });
+    if (limit > 0 && result.size() > limit) result.resize(limit);
+    return result;
+}
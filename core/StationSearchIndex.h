@@ -0,0 +1,79 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include "Station.h"
+
+/**
+ * @file stationsearchindex.h
+ * @brief Definicja klasy StationSearchIndex - indeksu wyszukiwania stacji
+ */
+
+/**
+ * @class StationSearchIndex
+ * @brief Wyszukiwanie stacji po nazwie i adresie niewrażliwe na polskie znaki
+ *
+ * Nazwa, miasto, gmina, powiat, województwo i ulica stacji są dzielone na słowa
+ * normalizowane do małych liter bez znaków diakrytycznych ("Łódź" -> "lodz").
+ * Posortowany słownik słów działa jak drzewo prefiksowe (wyszukiwanie binarne
+ * zakresu prefiksu), a indeks trigramów podsuwa kandydatów dla słów z literówkami.
+ * Każde słowo zapytania musi pasować do stacji; ostatnie może być niedokończone.
+ */
+class StationSearchIndex {
+public:
+    StationSearchIndex() = default;
+
+    /**
+     * @brief Konstruktor budujący indeks
+     * @param stations Stacje do zaindeksowania
+     */
+    explicit StationSearchIndex(const QVector<Station> &stations) { build(stations); }
+
+    /**
+     * @brief Buduje indeks od nowa
+     * @param stations Stacje do zaindeksowania
+     */
+    void build(const QVector<Station> &stations);
+
+    /**
+     * @brief Wyszukuje stacje
+     * @param query Zapytanie (np. "lodz czerni")
+     * @param limit Maksymalna liczba wyników (0 - bez limitu)
+     * @return Indeksy stacji od najlepiej dopasowanej (pusty wynik dla pustego zapytania)
+     * @note Trafienie dokładne waży więcej niż prefiks, a prefiks więcej niż słowo z literówką;
+     *       dopasowanie w nazwie lub mieście waży więcej niż w województwie
+     */
+    QVector<int> search(const QString &query, int limit = 0) const;
+
+    /**
+     * @brief Normalizuje tekst do porównań
+     * @param text Tekst źródłowy
+     * @return Tekst małymi literami bez znaków diakrytycznych
+     */
+    static QString normalize(const QString &text);
+
+    /**
+     * @brief Dzieli tekst na znormalizowane słowa
+     * @param text Tekst źródłowy
+     * @return Słowa (ciągi liter i cyfr)
+     */
+    static QStringList tokenize(const QString &text);
+
+private:
+    /**
+     * @struct Posting
+     * @brief Wystąpienie słowa w stacji
+     */
+    struct Posting {
+        int station;    ///< Indeks stacji
+        float weight;   ///< Waga najważniejszego pola stacji zawierającego słowo
+    };
+
+    QStringList m_words;                       ///< Posortowany słownik słów
+    QVector<QVector<Posting>> m_postings;      ///< Wystąpienia słów (indeksowane jak m_words)
+    QHash<QString, QVector<int>> m_trigrams;   ///< Słowa zawierające trigram
+    int m_stationCount = 0;                    ///< Liczba zaindeksowanych stacji
+
+    void matchWord(const QString &word, QVector<float> &best, QVector<int> &touched) const;
+};
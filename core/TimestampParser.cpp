@@ -0,0 +1,163 @@
+#include "TimestampParser.h"
+
+namespace {
+
+//parsuje n cyfr, zwraca -1 przy błędzie
+int digits(const char *d, int n) {
+    int value = 0;
+    for (int i = 0; i < n; ++i) {
+        const char c = d[i];
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int daysInMonth(int year, int month) {
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+}
+
+//północ UTC ostatniej niedzieli miesiąca (dni od epoki)
+qint64 lastSunday(int year, int month) {
+    const qint64 lastDay = TimestampParser::daysFromCivil(year, month, daysInMonth(year, month));
+    //1970-01-01 był czwartkiem (4), niedziela = 0
+    const qint64 weekday = ((lastDay + 4) % 7 + 7) % 7;
+    return lastDay - weekday;
+}
+
+}
+
+qint64 TimestampParser::daysFromCivil(int year, int month, int day) {
+    //algorytm H. Hinnanta - bez tablic i pętli
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+qint64 TimestampParser::warsawToUtc(int year, int month, int day, int secondsOfDay) {
+    const qint64 local = daysFromCivil(year, month, day) * 86400 + secondsOfDay;
+
+    //czas letni UE: od ostatniej niedzieli marca do ostatniej niedzieli października, 01:00 UTC
+    const qint64 summerStart = lastSunday(year, 3) * 86400 + 3600;
+    const qint64 summerEnd = lastSunday(year, 10) * 86400 + 3600;
+
+    const qint64 asSummer = local - 7200;
+    if (asSummer >= summerStart && asSummer < summerEnd) {
+        return asSummer;
+    }
+    return local - 3600;
+}
+
+int TimestampParser::warsawOffsetSecs(qint64 utcSecs) {
+    //rok z dnia (odwrotność daysFromCivil), granice czasu letniego nie leżą na przełomie roku
+    const qint64 days = utcSecs >= 0 ? utcSecs / 86400 : (utcSecs - 86399) / 86400;
+    const qint64 z = days + 719468;
+    const qint64 era = (z >= 0 ? z : z - 146096) / 146097;
+    const qint64 dayOfEra = z - era * 146097;
+    const qint64 yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const qint64 dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int year = int(yearOfEra + era * 400 + (dayOfYear >= 306 ? 1 : 0));
+
+    const qint64 summerStart = lastSunday(year, 3) * 86400 + 3600;
+    const qint64 summerEnd = lastSunday(year, 10) * 86400 + 3600;
+    return utcSecs >= summerStart && utcSecs < summerEnd ? 7200 : 3600;
+}
+
+qint64 TimestampParser::warsawDay(qint64 utcSecs) {
+    const qint64 local = utcSecs + warsawOffsetSecs(utcSecs);
+    return local >= 0 ? local / 86400 : (local - 86399) / 86400;
+}
+
+qint64 TimestampParser::parse(const char *d, qsizetype n) {
+    //yyyy-MM-dd HH:mm - minimalna długość
+    if (n < 16 || d[4] != '-' || d[7] != '-' || (d[10] != ' ' && d[10] != 'T') || d[13] != ':') {
+        return Invalid;
+    }
+
+    const int year = digits(d, 4);
+    const int month = digits(d + 5, 2);
+    const int day = digits(d + 8, 2);
+    const int hour = digits(d + 11, 2);
+    const int minute = digits(d + 14, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return Invalid;
+    }
+
+    qsizetype pos = 16;
+    int second = 0;
+    if (pos < n && d[pos] == ':') {
+        if (pos + 3 > n) return Invalid;
+        second = digits(d + pos + 1, 2);
+        if (second < 0 || second > 59) return Invalid;
+        pos += 3;
+
+        //ułamek sekundy pomijamy
+        if (pos < n && d[pos] == '.') {
+            ++pos;
+            while (pos < n && d[pos] >= '0' && d[pos] <= '9') ++pos;
+        }
+    }
+
+    const int secondsOfDay = hour * 3600 + minute * 60 + second;
+
+    //brak strefy - czas polski
+    if (pos == n) {
+        return warsawToUtc(year, month, day, secondsOfDay);
+    }
+
+    const qint64 wallClock = daysFromCivil(year, month, day) * 86400 + secondsOfDay;
+    if (d[pos] == 'Z' && pos + 1 == n) {
+        return wallClock;
+    }
+
+    //przesunięcie +HH:MM, +HHMM lub +HH
+    if (d[pos] != '+' && d[pos] != '-') return Invalid;
+    const int sign = d[pos] == '+' ? 1 : -1;
+    const qsizetype rest = n - pos - 1;
+    const char *offset = d + pos + 1;
+
+    int offsetHours = -1;
+    int offsetMinutes = 0;
+    if (rest == 2) {
+        offsetHours = digits(offset, 2);
+    } else if (rest == 4) {
+        offsetHours = digits(offset, 2);
+        offsetMinutes = digits(offset + 2, 2);
+    } else if (rest == 5 && offset[2] == ':') {
+        offsetHours = digits(offset, 2);
+        offsetMinutes = digits(offset + 3, 2);
+    }
+    if (offsetHours < 0 || offsetHours > 18 || offsetMinutes < 0 || offsetMinutes > 59) {
+        return Invalid;
+    }
+
+    return wallClock - sign * (offsetHours * 3600 + offsetMinutes * 60);
+}
+
+qint64 TimestampParser::parse(const QString &text) {
+    //znaczniki GIOS mają najwyżej ~30 znaków ASCII
+    char buffer[40];
+    const qsizetype n = text.size();
+    if (n > qsizetype(sizeof(buffer))) return Invalid;
+
+    const QChar *chars = text.constData();
+    for (qsizetype i = 0; i < n; ++i) {
+        const ushort c = chars[i].unicode();
+        if (c > 127) return Invalid;
+        buffer[i] = char(c);
+    }
+    return parse(buffer, n);
+}
+
+QDateTime TimestampParser::toDateTime(qint64 epochSecs) {
+    return epochSecs == Invalid ? QDateTime() : QDateTime::fromSecsSinceEpoch(epochSecs);
+}
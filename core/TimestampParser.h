@@ -0,0 +1,79 @@
+#pragma once
+#include <QString>
+#include <QDateTime>
+#include <limits>
+
+/**
+ * @file timestampparser.h
+ * @brief Definicja klasy TimestampParser parsującej znaczniki czasu API GIOS
+ */
+
+/**
+ * @class TimestampParser
+ * @brief Szybki parser znaczników czasu w stałym formacie GIOS
+ *
+ * Obsługuje zapis "yyyy-MM-dd HH:mm:ss" oraz wariant ISO z separatorem 'T',
+ * opcjonalnymi sekundami, ułamkiem sekundy i strefą ("Z", "+HH:MM").
+ * Czas bez strefy jest traktowany jako czas polski (CET/CEST według reguł UE)
+ * i zamieniany na sekundy UTC od epoki Unix bez użycia QDateTime i baz stref czasowych.
+ */
+class TimestampParser {
+public:
+    static constexpr qint64 Invalid = std::numeric_limits<qint64>::min(); ///< Wynik dla niepoprawnego tekstu
+
+    /**
+     * @brief Parsuje znacznik czasu zapisany w ASCII
+     * @param data Wskaźnik na tekst (nie musi kończyć się zerem)
+     * @param size Długość tekstu
+     * @return Sekundy UTC od epoki Unix lub Invalid
+     */
+    static qint64 parse(const char *data, qsizetype size);
+
+    /**
+     * @brief Parsuje znacznik czasu
+     * @param text Tekst znacznika czasu
+     * @return Sekundy UTC od epoki Unix lub Invalid
+     */
+    static qint64 parse(const QString &text);
+
+    /**
+     * @brief Zamienia czas lokalny Polski na sekundy UTC
+     * @param year Rok
+     * @param month Miesiąc (1-12)
+     * @param day Dzień miesiąca
+     * @param secondsOfDay Sekundy od północy czasu lokalnego
+     * @return Sekundy UTC od epoki Unix
+     * @note W godzinie powtarzanej przy zmianie na czas zimowy wybierane jest pierwsze wystąpienie
+     */
+    static qint64 warsawToUtc(int year, int month, int day, int secondsOfDay);
+
+    /**
+     * @brief Zwraca przesunięcie czasu polskiego względem UTC
+     * @param utcSecs Sekundy UTC od epoki Unix
+     * @return 3600 (CET) lub 7200 (CEST)
+     */
+    static int warsawOffsetSecs(qint64 utcSecs);
+
+    /**
+     * @brief Zwraca numer dnia kalendarzowego czasu polskiego
+     * @param utcSecs Sekundy UTC od epoki Unix
+     * @return Liczba dni od 1970-01-01 według daty lokalnej w Polsce
+     */
+    static qint64 warsawDay(qint64 utcSecs);
+
+    /**
+     * @brief Zwraca QDateTime dla sekund UTC (niepoprawny dla Invalid)
+     * @param epochSecs Sekundy od epoki Unix
+     * @return Obiekt QDateTime w czasie lokalnym
+     */
+    static QDateTime toDateTime(qint64 epochSecs);
+
+    /**
+     * @brief Zwraca liczbę dni od 1970-01-01 do podanej daty (kalendarz gregoriański)
+     * @param year Rok
+     * @param month Miesiąc (1-12)
+     * @param day Dzień miesiąca
+     * @return Liczba dni (ujemna przed 1970)
+     */
+    static qint64 daysFromCivil(int year, int month, int day);
+};
@@ -1,4 +1,6 @@
 #include "ApiHandler.h"
+#include "MeasurementDecoder.h"
+#include "AirQualityCalculator.h"
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -10,6 +12,7 @@
 
 
 ApiHandler::ApiHandler(QObject *parent) : QObject(parent),
+    m_worker(new NetworkWorker),
     m_apiBaseUrl("https://api.gios.gov.pl/pjp-api/rest"),
     m_isBusy(false),
     m_dbManager(new DatabaseManager(this))
@@ -19,177 +22,352 @@ ApiHandler::ApiHandler(QObject *parent) : QObject(parent),
         qCritical() << "SSL nie jest obsługiwany!";
         qDebug() << "Wersja kompilacji biblioteki SSL:" << QSslSocket::sslLibraryBuildVersionString();
     }
-    m_manager.setTransferTimeout(10000);
-    m_threadPool.setMaxThreadCount(4);
+
+    //cały ruch sieciowy w jednym dedykowanym wątku
+    m_worker->moveToThread(&m_networkThread);
+    connect(&m_networkThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &NetworkWorker::finished, this, &ApiHandler::handleNetworkResponse);
+    m_networkThread.setObjectName("ApiHandlerNetwork");
+    m_networkThread.start();
+
+    //pula wątków tylko do parsowania
+    m_threadPool.setMaxThreadCount(QThread::idealThreadCount());
+
+    //wysyłka wstrzymana przez brak tokenów wznawia się po ich odnowieniu
+    m_dispatchTimer.setSingleShot(true);
+    connect(&m_dispatchTimer, &QTimer::timeout, this, &ApiHandler::dispatchPending);
+    m_dispatchClock.start();
+
+    //adres API można podmienić np. na lokalny serwer zastępczy
+    const QString overrideUrl = qEnvironmentVariable("GIOS_API_URL");
+    if (!overrideUrl.isEmpty()) {
+        setApiUrl(overrideUrl);
+    }
+}
+
+ApiHandler::~ApiHandler() {
+    m_networkThread.quit();
+    m_networkThread.wait();
+    m_threadPool.waitForDone();
 }
 
 //podstawowe metody API
 //wielowątkowość
-void ApiHandler::fetchStations() {
-    if (m_isBusy) return;
+RequestHandle ApiHandler::fetchStations(RequestPriority priority) {
+    if (m_isBusy) return m_stationsFetch;
 
     m_isBusy = true;
+    m_stationsFetch = RequestHandle();
 
-    QFuture<void> future = QtConcurrent::run(&m_threadPool, [this]() {
-        QUrl url = buildUrl("station/findAll");
-        QNetworkRequest request = createRequest(url);
+    requestStations(priority, [this](bool ok, const QVector<Station> &stations) {
+        m_isBusy = false;
+        if (ok) emit stationsFetched(stations);
+    }, m_stationsFetch);
 
-        QNetworkReply *reply = m_manager.get(request);
+    return m_stationsFetch;
+}
 
-        QEventLoop loop;
-        connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-        loop.exec();
+//kolejne kliknięcie zastępuje poprzednie - wynik poprzedniego nie dociera do UI
+RequestHandle ApiHandler::fetchSensors(int stationId, RequestPriority priority) {
+    cancel(m_sensorsFetch);
+    m_sensorsFetch = RequestHandle();
 
-        handleStationsReplyImpl(reply);
-        reply->deleteLater();
-    });
+    requestSensors(stationId, priority, [this](bool ok, const QVector<Sensor> &sensors) {
+        if (ok) emit sensorsFetched(sensors);
+    }, m_sensorsFetch);
 
-    QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
-    connect(watcher, &QFutureWatcher<void>::finished, watcher, &QFutureWatcher<void>::deleteLater);
-    watcher->setFuture(future);
+    return m_sensorsFetch;
 }
 
-//wielowątkowość dod metoda
-void ApiHandler::handleStationsReplyImpl(QNetworkReply* reply) {
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+RequestHandle ApiHandler::fetchMeasurements(int sensorId, const QDateTime& from, const QDateTime& to,
+                                            RequestPriority priority) {
+    cancel(m_measurementsFetch);
+    m_measurementsFetch = RequestHandle();
 
-    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
-        emit apiError("Błąd danych");
-        return;
-    }
+    MeasurementCallback emitResult = [this](bool ok, const Measurement &measurement) {
+        if (ok) emit measurementsFetched(measurement);
+    };
 
-    QVector<Station> stations;
-    foreach (const QJsonValue &value, doc.array()) {
-        if (value.isObject()) {
-            stations.append(Station(value.toObject()));
-        }
+    //jawny zakres - zwykłe pobranie, bez zakresu - synchronizacja przyrostowa
+    if (from.isValid() || to.isValid()) {
+        requestMeasurements(sensorId, from, to, priority, emitResult, m_measurementsFetch);
+    } else {
+        syncMeasurements(sensorId, priority, emitResult, m_measurementsFetch);
     }
 
-    updateStations(stations);
+    return m_measurementsFetch;
+}
 
-    QMetaObject::invokeMethod(this, [this, stations]() {
+void ApiHandler::cancel(const RequestHandle &handle) {
+    handle.markCancelled();
+    if (handle == m_stationsFetch) {
         m_isBusy = false;
-        emit stationsFetched(stations);
-    }, Qt::QueuedConnection);
+    }
+
+    const QString key = handle.key();
+    if (key.isEmpty()) return;
+
+    //żądanie porzucamy tylko, gdy nikt inny (np. pełna aktualizacja) nie czeka na wynik
+    const bool abandoned = m_stationsRequests.abandonIfCancelled(key) ||
+                           m_sensorsRequests.abandonIfCancelled(key) ||
+                           m_measurementsRequests.abandonIfCancelled(key) ||
+                           m_indexRequests.abandonIfCancelled(key);
+    if (abandoned) {
+        abandonRequest(key);
+    }
 }
 
-//wielowątkowość
-void ApiHandler::fetchSensors(int stationId) {
-    m_threadPool.start([this, stationId]() {
-        QUrl url = buildUrl(QString("station/sensors/%1").arg(stationId));
-        QNetworkRequest request = createRequest(url);
+//synchronizacja przyrostowa - pobieramy i zapisujemy tylko punkty nowsze niż high-water mark
+void ApiHandler::syncMeasurements(int sensorId, RequestPriority priority, MeasurementCallback callback,
+                                  const RequestHandle &handle) {
+    const QDateTime highWaterMark = measurementHighWaterMark(sensorId);
+
+    requestMeasurements(sensorId, highWaterMark, QDateTime(), priority,
+                        [this, sensorId, highWaterMark, callback](bool ok, const Measurement &fresh) {
+        if (!ok) {
+            callback(false, fresh);
+            return;
+        }
 
-        QNetworkReply *reply = m_manager.get(request);
+        //odpowiedź mogła już obsłużyć pełna aktualizacja - jej punkty trafiają do bazy przed odczytem okna
+        const QDateTime accepted = measurementHighWaterMark(sensorId);
+        Measurement series = acceptNewMeasurements(fresh);
+        storePendingMeasurements();
 
-        QEventLoop loop;
-        connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-        loop.exec();
+        //starsza część okna i punkty przyjęte wcześniej pochodzą z bazy danych (razem z flagami anomalii)
+        if (accepted.isValid()) {
+            const QDateTime from = highWaterMark.isValid() ? highWaterMark.addSecs(-SyncWindowHours * 3600)
+                                                           : QDateTime();
+            series.merge(m_dbManager->loadMeasurements(sensorId, from, accepted));
+        }
 
-        handleSensorsReplyImpl(reply);
-        reply->deleteLater();
-    });
+        callback(true, series);
+    }, handle);
 }
 
-//wielowątkowość dod
-void ApiHandler::handleSensorsReplyImpl(QNetworkReply* reply) {
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+Measurement ApiHandler::acceptNewMeasurements(const Measurement &fresh) {
+    //punkty do high-water mark przyjął już inny odbiorca - bez ponownej detekcji i zapisu
+    const int sensorId = fresh.sensorId();
+    Measurement series = fresh.newerThan(measurementHighWaterMark(sensorId));
+    if (series.isEmpty()) return series;
 
-    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
-        emit apiError("Błąd danych sensorów");
-        return;
+    flagAnomalies(series);
+    m_pendingMeasurements.append(series);
+
+    //high-water mark przesuwamy od razu, zapis może czekać na pakiet pełnej aktualizacji
+    QDateTime &mark = m_highWaterMarks[sensorId];
+    qint64 latest = mark.isValid() ? mark.toSecsSinceEpoch() : Measurement::InvalidTime;
+
+    const QVector<qint64> &times = series.times();
+    for (int i = 0; i < times.size(); ++i) {
+        if (series.isValidAt(i) && times[i] > latest) {
+            latest = times[i];
+        }
     }
+    if (latest != Measurement::InvalidTime) {
+        mark = QDateTime::fromSecsSinceEpoch(latest);
+    }
+    return series;
+}
 
-    QVector<Sensor> sensors;
-    foreach (const QJsonValue &value, doc.array()) {
-        if (value.isObject()) {
-            try {
-                sensors.append(Sensor(value.toObject()));
-            } catch (...) {
-            }
+void ApiHandler::flagAnomalies(Measurement &measurement) {
+    if (measurement.isEmpty()) return;
+
+    const int sensorId = measurement.sensorId();
+    auto it = m_detectors.find(sensorId);
+    if (it == m_detectors.end()) {
+        it = m_detectors.insert(sensorId, AnomalyDetector(measurement.paramCode()));
+
+        //rozgrzewka zapisaną historią, jej flagi zostają bez zmian
+        const QDateTime highWaterMark = measurementHighWaterMark(sensorId);
+        if (highWaterMark.isValid()) {
+            Measurement history(measurement.paramCode(), sensorId);
+            history.merge(m_dbManager->loadMeasurements(sensorId, highWaterMark.addDays(-DetectorSeedDays),
+                                                        highWaterMark));
+            history.detectAnomalies(it.value());
         }
     }
 
-    QMetaObject::invokeMethod(this, [this, sensors]() {
-        emit sensorsFetched(sensors);
-    }, Qt::QueuedConnection);
+    const int flagged = measurement.detectAnomalies(it.value());
+    if (flagged > 0) {
+        qDebug() << "Czujnik" << sensorId << "- punkty z anomaliami:" << flagged;
+    }
 }
 
-//wielowątkowość
-void ApiHandler::fetchMeasurements(int sensorId, const QDateTime& from, const QDateTime& to) {
-    m_threadPool.start([this, sensorId, from, to]() {
-        QString endpoint = QString("data/getData/%1").arg(sensorId);
-        QUrl url = buildUrl(endpoint);
+QDateTime ApiHandler::measurementHighWaterMark(int sensorId) {
+    auto it = m_highWaterMarks.constFind(sensorId);
+    if (it != m_highWaterMarks.constEnd()) {
+        return it.value();
+    }
 
-        QUrlQuery query;
-        if (from.isValid()) query.addQueryItem("from", from.toString(Qt::ISODate));
-        if (to.isValid()) query.addQueryItem("to", to.toString(Qt::ISODate));
-        if (!query.isEmpty()) url.setQuery(query);
+    const QDateTime latest = m_dbManager->latestMeasurementTime(sensorId);
+    m_highWaterMarks.insert(sensorId, latest);
+    return latest;
+}
 
-        QNetworkRequest request = createRequest(url);
-        QNetworkReply *reply = m_manager.get(request);
+void ApiHandler::storePendingMeasurements() {
+    if (m_pendingMeasurements.isEmpty()) return;
 
-        QEventLoop loop;
-        connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-        loop.exec();
+    QVector<Measurement> pending;
+    pending.swap(m_pendingMeasurements);
+    if (m_dbManager->saveMeasurements(pending)) return;
 
-        handleMeasurementsReplyImpl(reply, sensorId, from, to);
-        reply->deleteLater();
-    });
+    //nieudany zapis - high-water mark i detektor odtwarzamy z bazy, punkty zostaną pobrane ponownie
+    for (const auto &measurement : pending) {
+        m_highWaterMarks.remove(measurement.sensorId());
+        m_detectors.remove(measurement.sensorId());
+    }
 }
 
-//wielowątkowość dod
-void ApiHandler::handleMeasurementsReplyImpl(QNetworkReply* reply, int sensorId, const QDateTime& from, const QDateTime& to) {
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+RequestHandle ApiHandler::fetchAirQualityIndex(int stationId, RequestPriority priority) {
+    cancel(m_indexFetch);
+    m_indexFetch = RequestHandle();
 
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        emit apiError("Błąd danych pomiarów");
+    requestAirQualityIndex(stationId, priority, [this](bool ok, const AirQualityIndex &index) {
+        if (ok) emit airQualityIndexFetched(index);
+    }, m_indexFetch);
+
+    return m_indexFetch;
+}
+
+//żądania z wynikiem przekazywanym do callbacku (wspólne dla UI i trybu crawl)
+//równoczesne żądania o ten sam URL są łączone - jedno żądanie i jedno parsowanie
+//odpowiedź z pamięci podręcznej HTTP o znanym walidatorze nie jest parsowana ponownie
+void ApiHandler::requestStations(RequestPriority priority, StationsCallback callback,
+                                 const RequestHandle &handle) {
+    QUrl url = buildUrl("station/findAll");
+    const QString key = normalizedUrlKey(url);
+    if (!m_stationsRequests.join(key, std::move(callback), handle)) {
+        promoteRequest(key, priority);
         return;
     }
 
-    try {
-        Measurement measurement(doc.object());
+    const CancelFlag cancelled = beginRequest(key);
+    StationsCallback done = [this, key, cancelled](bool ok, const QVector<Station> &stations) {
+        if (!finishRequest(key, cancelled)) return;
+        m_stationsRequests.complete(key, ok, stations);
+    };
 
-        QMetaObject::invokeMethod(this, [this, measurement]() {
-            emit measurementsFetched(measurement);
-        }, Qt::QueuedConnection);
-    } catch (...) {
-        emit apiError("Błąd przetwarzania pomiarów");
-    }
+    sendRequest(url, [this, key, priority, cancelled, done](const NetworkResponse &response) {
+        if (!handleError(response)) {
+            done(false, {});
+            return;
+        }
+        if (reuseParsed(m_parsedStations, key, response, done)) return;
+
+        StationsCallback parsed = rememberParsed(m_parsedStations, key, response.validator, done);
+        m_threadPool.start([this, body = response.body, parsed, cancelled]() {
+            if (cancelled->load()) return;
+            handleStationsReplyImpl(body, parsed);
+        }, poolPriority(priority));
+    }, priority);
 }
 
+void ApiHandler::requestSensors(int stationId, RequestPriority priority, SensorsCallback callback,
+                                const RequestHandle &handle) {
+    QUrl url = buildUrl(QString("station/sensors/%1").arg(stationId));
+    const QString key = normalizedUrlKey(url);
+    if (!m_sensorsRequests.join(key, std::move(callback), handle)) {
+        promoteRequest(key, priority);
+        return;
+    }
 
-void ApiHandler::fetchAirQualityIndex(int stationId) {
-    QUrl url = buildUrl(QString("aqindex/getIndex/%1").arg(stationId));
-    QNetworkRequest request = createRequest(url);
+    const CancelFlag cancelled = beginRequest(key);
+    SensorsCallback done = [this, key, cancelled](bool ok, const QVector<Sensor> &sensors) {
+        if (!finishRequest(key, cancelled)) return;
+        m_sensorsRequests.complete(key, ok, sensors);
+    };
 
-    QNetworkReply *reply = m_manager.get(request);
-    connect(reply, &QNetworkReply::finished, this, &ApiHandler::handleAirQualityIndexReply);
-    connect(reply, &QNetworkReply::errorOccurred, this, &ApiHandler::handleNetworkError);
+    sendRequest(url, [this, key, priority, cancelled, done](const NetworkResponse &response) {
+        if (!handleError(response)) {
+            done(false, {});
+            return;
+        }
+        if (reuseParsed(m_parsedSensors, key, response, done)) return;
+
+        SensorsCallback parsed = rememberParsed(m_parsedSensors, key, response.validator, done);
+        m_threadPool.start([this, body = response.body, parsed, cancelled]() {
+            if (cancelled->load()) return;
+            handleSensorsReplyImpl(body, parsed);
+        }, poolPriority(priority));
+    }, priority);
 }
 
-//procedury obsługi odpowiedzi
-void ApiHandler::handleStationsReply() {
-    QScopedPointer<QNetworkReply, QScopedPointerDeleteLater> reply(qobject_cast<QNetworkReply*>(sender()));
-    m_isBusy = false;
+void ApiHandler::requestMeasurements(int sensorId, const QDateTime& from, const QDateTime& to,
+                                     RequestPriority priority, MeasurementCallback callback,
+                                     const RequestHandle &handle) {
+    QString endpoint = QString("data/getData/%1").arg(sensorId);
+    QUrl url = buildUrl(endpoint);
+
+    QUrlQuery query;
+    if (from.isValid()) query.addQueryItem("from", from.toString(Qt::ISODate));
+    if (to.isValid()) query.addQueryItem("to", to.toString(Qt::ISODate));
+    if (!query.isEmpty()) url.setQuery(query);
 
-    if (!reply || reply->error() != QNetworkReply::NoError) {
-        emit networkError(reply ? reply->errorString() : "Nieprawidłowy obiekt odpowiedzi");
+    const QString key = normalizedUrlKey(url);
+    if (!m_measurementsRequests.join(key, std::move(callback), handle)) {
+        promoteRequest(key, priority);
         return;
     }
 
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+    const CancelFlag cancelled = beginRequest(key);
+    MeasurementCallback done = [this, key, cancelled](bool ok, const Measurement &measurement) {
+        if (!finishRequest(key, cancelled)) return;
+        m_measurementsRequests.complete(key, ok, measurement);
+    };
 
-    if (parseError.error != QJsonParseError::NoError) {
-        emit apiError(QString("Błąd analizy JSON: %1").arg(parseError.errorString()));
+    //treść dekodowana strumieniowo w wątku sieciowym, pula tylko sortuje i przekazuje wynik
+    sendRequest(url, [this, sensorId, priority, cancelled, done](const NetworkResponse &response) {
+        if (!handleError(response)) {
+            done(false, Measurement());
+            return;
+        }
+
+        m_threadPool.start([this, decoder = response.decoder, sensorId, done, cancelled]() {
+            if (cancelled->load()) return;
+            handleMeasurementsReplyImpl(decoder, sensorId, done);
+        }, poolPriority(priority));
+    }, priority, false, sensorId); //zakres "from" zmienia się co godzinę - wpisy w pamięci podręcznej byłyby jednorazowe
+}
+
+void ApiHandler::requestAirQualityIndex(int stationId, RequestPriority priority, IndexCallback callback,
+                                        const RequestHandle &handle) {
+    QUrl url = buildUrl(QString("aqindex/getIndex/%1").arg(stationId));
+    const QString key = normalizedUrlKey(url);
+    if (!m_indexRequests.join(key, std::move(callback), handle)) {
+        promoteRequest(key, priority);
         return;
     }
 
-    if (!doc.isArray()) {
-        emit apiError("Nieprawidłowy format odpowiedzi: oczekiwana tablica JSON");
+    const CancelFlag cancelled = beginRequest(key);
+    IndexCallback done = [this, key, cancelled](bool ok, const AirQualityIndex &index) {
+        if (!finishRequest(key, cancelled)) return;
+        m_indexRequests.complete(key, ok, index);
+    };
+
+    sendRequest(url, [this, key, priority, cancelled, done](const NetworkResponse &response) {
+        if (!handleError(response)) {
+            done(false, AirQualityIndex());
+            return;
+        }
+        if (reuseParsed(m_parsedIndices, key, response, done)) return;
+
+        IndexCallback parsed = rememberParsed(m_parsedIndices, key, response.validator, done);
+        m_threadPool.start([this, body = response.body, parsed, cancelled]() {
+            if (cancelled->load()) return;
+            handleAirQualityIndexReplyImpl(body, parsed);
+        }, poolPriority(priority));
+    }, priority);
+}
+
+//wielowątkowość dod metoda
+void ApiHandler::handleStationsReplyImpl(const QByteArray& body, StationsCallback callback) {
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
+
+    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
+        emit apiError("Błąd danych");
+        deliverResult(callback, false, QVector<Station>());
         return;
     }
 
@@ -200,41 +378,18 @@ void ApiHandler::handleStationsReply() {
         }
     }
 
-    if (stations.isEmpty()) {
-        qDebug() << "Otrzymano listę pustych stacji";
-    }
-
     updateStations(stations);
-
-    if (!stations.isEmpty()) {
-        for (const auto &station : stations) {
-            m_dbManager->saveStation(station);
-        }
-    }
-    emit stationsFetched(stations);
-
-    qDebug() << "Odebrano odpowiedź API!";
-
+    deliverResult(callback, true, stations);
 }
 
-void ApiHandler::handleSensorsReply() {
-    QScopedPointer<QNetworkReply, QScopedPointerDeleteLater> reply(qobject_cast<QNetworkReply*>(sender()));
-
-    if (!reply || reply->error() != QNetworkReply::NoError) {
-        emit networkError(reply ? reply->errorString() : "Nieprawidłowy obiekt odpowiedzi");
-        return;
-    }
-
+//wielowątkowość dod
+void ApiHandler::handleSensorsReplyImpl(const QByteArray& body, SensorsCallback callback) {
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
-
-    if (parseError.error != QJsonParseError::NoError) {
-        emit apiError(QString("Błąd analizy JSON: %1").arg(parseError.errorString()));
-        return;
-    }
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
 
-    if (!doc.isArray()) {
-        emit apiError("Nieprawidłowy format odpowiedzi: oczekiwana tablica JSON");
+    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
+        emit apiError("Błąd danych sensorów");
+        deliverResult(callback, false, QVector<Sensor>());
         return;
     }
 
@@ -243,131 +398,282 @@ void ApiHandler::handleSensorsReply() {
         if (value.isObject()) {
             try {
                 sensors.append(Sensor(value.toObject()));
-            } catch (const std::exception &e) {
-                qWarning() << "Nie udało się utworzyć czujnika:" << e.what();
+            } catch (...) {
             }
         }
     }
 
-    emit sensorsFetched(sensors);
+    deliverResult(callback, true, sensors);
 }
 
-void ApiHandler::handleMeasurementsReply() {
-    QScopedPointer<QNetworkReply, QScopedPointerDeleteLater> reply(qobject_cast<QNetworkReply*>(sender()));
-
-    if (!reply || reply->error() != QNetworkReply::NoError) {
-        emit networkError(reply ? reply->errorString() : "Nieprawidłowy obiekt odpowiedzi");
+//wielowątkowość dod
+void ApiHandler::handleMeasurementsReplyImpl(const std::shared_ptr<MeasurementDecoder>& decoder, int sensorId,
+                                             MeasurementCallback callback) {
+    //punkty trafiły prosto do Measurement w trakcie pobierania, bez QJsonDocument
+    if (!decoder || decoder->hasError()) {
+        qWarning() << "Błąd danych pomiarów czujnika" << sensorId << ":"
+                   << (decoder ? decoder->errorString() : QString("brak dekodera"));
+        emit apiError("Błąd danych pomiarów");
+        deliverResult(callback, false, Measurement());
         return;
     }
 
-    //get the json data from the reply
-    QByteArray responseData = reply->readAll();
+    deliverResult(callback, true, decoder->takeMeasurement());
+}
+
+void ApiHandler::handleAirQualityIndexReplyImpl(const QByteArray& body, IndexCallback callback) {
     QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
+    QJsonDocument doc = QJsonDocument::fromJson(body, &parseError);
 
     if (parseError.error != QJsonParseError::NoError) {
-        emit apiError(QString("JSON parse error: %1").arg(parseError.errorString()));
+        emit apiError(QString("Błąd analizy JSON: %1").arg(parseError.errorString()));
+        deliverResult(callback, false, AirQualityIndex());
         return;
     }
 
     if (!doc.isObject()) {
         emit apiError("Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON");
+        deliverResult(callback, false, AirQualityIndex());
         return;
     }
 
-    // pobranie przekazanych właściwości
-    int sensorId = reply->property("sensorId").toInt();
-    QDateTime requestedFrom = reply->property("requestedFrom").toDateTime();
-    QDateTime requestedTo = reply->property("requestedTo").toDateTime();
-
     try {
-        Measurement measurement(doc.object());
+        AirQualityIndex index(doc.object());
+        deliverResult(callback, true, index);
+    } catch (const std::exception& e) {
+        emit apiError(QString("Nie udało się przeanalizować indeksu jakości powietrza: %1").arg(e.what()));
+        qCritical() << "Nieudane dane JSON:" << doc.toJson(QJsonDocument::Indented);
+        deliverResult(callback, false, AirQualityIndex());
+    }
+}
+
+//tryb crawl - pełna aktualizacja wszystkich stacji
+void ApiHandler::startCrawl(int maxConcurrent) {
+    if (m_crawl.running) return;
 
-        // dodatkowe info o przedziale czasowym
-        if (!measurement.data().isEmpty()) {
-            QDateTime actualFrom = measurement.data().first().timestamp;
-            QDateTime actualTo = measurement.data().last().timestamp;
+    m_crawl = CrawlState();
+    m_crawl.running = true;
+    m_crawl.maxConcurrent = qMax(0, maxConcurrent);
+    m_crawlElapsed.start();
 
-            qDebug() << "Są dane dla czujnika" << sensorId
-                     << "| Żądany zakres:" << requestedFrom << "-" << requestedTo
-                     << "| Rzeczywisty zakres:" << actualFrom << "-" << actualTo;
+    qDebug() << "Rozpoczęto pełną aktualizację, równoległość:"
+             << (m_crawl.maxConcurrent > 0 ? QString::number(m_crawl.maxConcurrent) : QString("adaptacyjna"));
+
+    requestStations(RequestPriority::Bulk, [this](bool ok, const QVector<Station> &stations) {
+        if (!ok) {
+            m_crawl.running = false;
+            emit crawlFinished(0, 0, 1);
+            return;
         }
 
-        emit measurementsFetched(measurement);
+        m_crawl.stations = stations.size();
+        m_crawl.pendingStations = stations;
+        emit stationsFetched(stations);
+
+        for (const auto &station : stations) {
+            m_crawl.queue.enqueue({CrawlTask::Sensors, station.id()});
+        }
+        m_crawl.total = m_crawl.queue.size();
+
+        emit crawlProgress(0, m_crawl.total);
+
+        //pusta lista stacji - żadne zadanie nie zakończy aktualizacji
+        if (m_crawl.queue.isEmpty()) {
+            completeCrawl();
+            return;
+        }
+        pumpCrawl();
+    });
+}
+
+void ApiHandler::startPeriodicCrawl(int intervalMs, int maxConcurrent) {
+    m_crawlConcurrency = maxConcurrent;
+
+    if (!m_crawlTimer) {
+        m_crawlTimer = new QTimer(this);
+        connect(m_crawlTimer, &QTimer::timeout, this, [this]() {
+            startCrawl(m_crawlConcurrency);
+        });
     }
-    catch (const std::exception& e) {
-        emit apiError(QString("Błąd przetwarzania pomiaru: %1").arg(e.what()));
+
+    m_crawlTimer->start(intervalMs);
+    startCrawl(m_crawlConcurrency);
+}
+
+void ApiHandler::stopPeriodicCrawl() {
+    if (m_crawlTimer) {
+        m_crawlTimer->stop();
     }
-    catch (...) {
-        emit apiError("Nieznany błąd przetwarzania pomiarów");
+}
+
+void ApiHandler::pumpCrawl() {
+    //bez jawnego limitu równoległość wyznacza kontroler ruchu
+    const int limit = m_crawl.maxConcurrent > 0 ? m_crawl.maxConcurrent : m_traffic.concurrencyLimit();
+
+    while (m_crawl.inFlight < limit && !m_crawl.queue.isEmpty()) {
+        CrawlTask task = m_crawl.queue.dequeue();
+        ++m_crawl.inFlight;
+
+        switch (task.kind) {
+        case CrawlTask::Sensors:
+            requestSensors(task.id, RequestPriority::Bulk, [this](bool ok, const QVector<Sensor> &sensors) {
+                if (ok) {
+                    m_crawl.sensors += sensors;
+                    //dane czujników na początek kolejki - ogranicza ilość buforowanych wyników
+                    for (auto it = sensors.crbegin(); it != sensors.crend(); ++it) {
+                        m_crawl.queue.prepend({CrawlTask::Data, it->id()});
+                    }
+                    m_crawl.total += sensors.size();
+                }
+                finishCrawlTask(ok);
+            });
+            break;
+
+        case CrawlTask::Data: {
+            requestMeasurements(task.id, measurementHighWaterMark(task.id), QDateTime(), RequestPriority::Bulk,
+                                [this](bool ok, const Measurement &measurement) {
+                if (ok) {
+                    //zakres godzin do przeliczenia historii indeksu
+                    const QVector<qint64> &times = acceptNewMeasurements(measurement).times();
+                    for (qint64 time : times) {
+                        if (time == Measurement::InvalidTime) continue;
+                        if (m_crawl.oldestNewTime == Measurement::InvalidTime || time < m_crawl.oldestNewTime) {
+                            m_crawl.oldestNewTime = time;
+                        }
+                    }
+                }
+                finishCrawlTask(ok);
+            });
+            break;
+        }
+        }
     }
 }
 
-void ApiHandler::handleAirQualityIndexReply() {
-    QScopedPointer<QNetworkReply, QScopedPointerDeleteLater> reply(qobject_cast<QNetworkReply*>(sender()));
+void ApiHandler::finishCrawlTask(bool ok) {
+    --m_crawl.inFlight;
+    ++m_crawl.completed;
+    if (!ok) ++m_crawl.failed;
+
+    emit crawlProgress(m_crawl.completed, m_crawl.total);
+
+    const int buffered = m_crawl.sensors.size() + m_pendingMeasurements.size();
+    const bool done = m_crawl.queue.isEmpty() && m_crawl.inFlight == 0;
 
-    if (!reply || reply->error() != QNetworkReply::NoError) {
-        emit networkError(reply ? reply->errorString() : "Nieprawidłowy obiekt odpowiedzi");
+    if (done) {
+        completeCrawl();
         return;
     }
 
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+    if (buffered >= CrawlBatchSize) {
+        flushCrawlBatch();
+    }
+    pumpCrawl();
+}
 
-    if (parseError.error != QJsonParseError::NoError) {
-        emit apiError(QString("Błąd analizy JSON: %1").arg(parseError.errorString()));
-        return;
+void ApiHandler::completeCrawl() {
+    flushCrawlBatch();
+    refreshLocalIndices();
+    m_crawl.running = false;
+    qDebug() << "Pełna aktualizacja zakończona w" << m_crawlElapsed.elapsed() << "ms, zadania:"
+             << m_crawl.completed << "błędy:" << m_crawl.failed
+             << "limit:" << m_traffic.concurrencyLimit() << "tempo:" << m_traffic.rate()
+             << "p50/p95:" << m_traffic.latencyPercentile(0.5) << m_traffic.latencyPercentile(0.95) << "ms";
+    emit crawlFinished(m_crawl.stations, m_crawl.sensorCount, m_crawl.failed);
+}
+
+void ApiHandler::flushCrawlBatch() {
+    //zapis w wątku głównym - połączenie SQLite należy do tego wątku
+    if (!m_crawl.pendingStations.isEmpty()) {
+        m_dbManager->saveStations(m_crawl.pendingStations);
+        m_crawl.pendingStations.clear();
+    }
+    if (!m_crawl.sensors.isEmpty()) {
+        m_dbManager->saveSensors(m_crawl.sensors);
+        m_crawl.sensorCount += m_crawl.sensors.size();
+        m_crawl.sensors.clear();
     }
+    storePendingMeasurements();
+}
 
-    if (!doc.isObject()) {
-        emit apiError("Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON");
-        return;
+void ApiHandler::refreshLocalIndices() {
+    //godziny z nowymi pomiarami (co najmniej ostatnie 6) wszystkich stacji jednym zapytaniem
+    qint64 from = QDateTime::currentSecsSinceEpoch() - 6 * 3600;
+    if (m_crawl.oldestNewTime != Measurement::InvalidTime) {
+        from = qMin(from, m_crawl.oldestNewTime);
     }
+    from -= from % 3600; //pełna pierwsza godzina
+    const QHash<int, QVector<Measurement>> stations =
+        m_dbManager->loadStationSeries({}, QDateTime::fromSecsSinceEpoch(from), QDateTime());
 
-    try {
-        AirQualityIndex index(doc.object());
-        emit airQualityIndexFetched(index);
-    } catch (const std::exception& e) {
-        emit apiError(QString("Nie udało się przeanalizować indeksu jakości powietrza: %1").arg(e.what()));
-        qCritical() << "Nieudane dane JSON:" << doc.toJson(QJsonDocument::Indented);
+    //historia godzinowa i aktualne indeksy liczone równolegle dla wszystkich stacji
+    const QVector<AirQualityCalculator::IndexHistory> histories = AirQualityCalculator::histories(stations);
+    m_dbManager->saveIndexHistories(histories);
+
+    const QVector<AirQualityIndex> indices = AirQualityCalculator::latestAll(stations);
+    if (!indices.isEmpty()) {
+        m_dbManager->saveAirQualityIndices(indices);
     }
+    qDebug() << "Przeliczono lokalnie indeksy jakości powietrza dla" << indices.size() << "stacji, godziny od"
+             << QDateTime::fromSecsSinceEpoch(from).toString(Qt::ISODate);
 }
 
 //metody filtracji
-//wątki
 void ApiHandler::filterStationsByCity(const QString& city) {
-    QFutureWatcher<Station>* watcher = new QFutureWatcher<Station>(this);
-
-    connect(watcher, &QFutureWatcher<Station>::finished, this, [=]() {
-        QVector<Station> filtered = watcher->future().results();
-        emit stationsFiltered(filtered);
-        watcher->deleteLater();  //sprzątanie
-    });
-
-    QFuture<Station> future = QtConcurrent::filtered(m_allStations,
-                                                     [city](const Station& s) { return s.isInCity(city); });
+    emit stationsFiltered(searchStations(city));
+}
 
-    watcher->setFuture(future);
+QVector<Station> ApiHandler::searchStations(const QString& query, int limit) const {
+    QMutexLocker locker(&m_dataMutex);
+    QVector<Station> result;
+    for (int index : m_stationSearch.search(query, limit)) {
+        result.append(m_allStations[index]);
+    }
+    return result;
 }
 
 void ApiHandler::findStationsInRadius(double lat, double lon, double radiusKm) {
-    //otrzymujemy bezpieczną kopię danych
-    QVector<Station> stationsCopy = getAllStations();
-
     QVector<Station> result;
-    std::copy_if(stationsCopy.begin(), stationsCopy.end(), std::back_inserter(result),
-                 [lat, lon, radiusKm](const Station& s) {
-                     return s.distanceTo(lat, lon) <= radiusKm;
-                 });
+    {
+        //kopiujemy tylko znalezione stacje
+        QMutexLocker locker(&m_dataMutex);
+        for (const StationIndex::Hit &hit : m_stationIndex.withinRadius(lat, lon, radiusKm)) {
+            result.append(m_allStations[hit.index]);
+        }
+    }
 
     emit stationsFiltered(result);
 }
 
+QVector<Station> ApiHandler::nearestStations(double lat, double lon, int count) const {
+    QMutexLocker locker(&m_dataMutex);
+    QVector<Station> result;
+    for (const StationIndex::Hit &hit : m_stationIndex.nearest(lat, lon, count)) {
+        result.append(m_allStations[hit.index]);
+    }
+    return result;
+}
+
 //metody pomocnicze
 QUrl ApiHandler::buildUrl(const QString &endpoint) const {
     return QUrl(m_apiBaseUrl + "/" + endpoint);
 }
 
+QString ApiHandler::normalizedUrlKey(const QUrl &url) {
+    QUrl normalized = url.adjusted(QUrl::NormalizePathSegments | QUrl::StripTrailingSlash |
+                                   QUrl::RemoveFragment);
+
+    //kolejność parametrów zapytania nie wpływa na klucz
+    QList<QPair<QString, QString>> items = QUrlQuery(normalized).queryItems(QUrl::FullyDecoded);
+    std::sort(items.begin(), items.end());
+
+    QUrlQuery sorted;
+    sorted.setQueryItems(items);
+    normalized.setQuery(sorted);
+
+    return normalized.toString(QUrl::FullyEncoded);
+}
+
 QNetworkRequest ApiHandler::createRequest(const QUrl &url) const {
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
@@ -381,21 +687,244 @@ QNetworkRequest ApiHandler::createRequest(const QUrl &url) const {
     return request;
 }
 
-void ApiHandler::handleNetworkError(QNetworkReply::NetworkError code) {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
+quint64 ApiHandler::sendRequest(const QUrl &url, ResponseHandler handler, RequestPriority priority,
+                                bool cacheable, int streamSensorId) {
+    const quint64 requestId = m_nextRequestId++;
+    m_pendingRequests.insert(requestId, std::move(handler));
 
-    //ignor wszystkich błędów oprócz najważniejszych
-    if (code != QNetworkReply::HostNotFoundError &&
-        code != QNetworkReply::ConnectionRefusedError) {
-        reply->deleteLater();
+    //żądanie czeka w kolejce na zgodę kontrolera ruchu, odpowiedź wraca przez handleNetworkResponse
+    QNetworkRequest request = createRequest(url);
+    if (cacheable) {
+        //świeży wpis bez ruchu sieciowego, przeterminowany - żądanie warunkowe
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+    } else {
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    }
+    const QString key = normalizedUrlKey(url);
+    m_requestIdsByKey.insert(key, requestId);
+    m_dispatchQueues[int(priority)].enqueue({requestId, request, key, priority, m_dispatchClock.elapsed(),
+                                             streamSensorId});
+    dispatchPending();
+
+    return requestId;
+}
+
+void ApiHandler::dispatchPending() {
+    //kolejki od najwyższego priorytetu - niższa klasa czeka, dopóki wyższa ma oczekujące żądania
+    for (int p = 0; p < PriorityCount; ++p) {
+        QQueue<DispatchItem> &queue = m_dispatchQueues[p];
+        const bool interactive = p == int(RequestPriority::Interactive);
+
+        while (!queue.isEmpty()) {
+            //żądanie interaktywne przejmuje miejsce żądania masowego
+            if (m_inFlight >= m_traffic.concurrencyLimit() && !(interactive && preemptBulkRequest())) {
+                return;
+            }
+
+            if (interactive) {
+                m_traffic.forceAcquire();
+            } else if (!m_traffic.tryAcquire()) {
+                if (!m_dispatchTimer.isActive()) {
+                    m_dispatchTimer.start(qMax(1, m_traffic.msUntilToken()));
+                }
+                return;
+            }
+
+            DispatchItem item = queue.dequeue();
+            item.request.setTransferTimeout(m_traffic.timeoutMs());
+
+            QueueCounters &counters = m_queueCounters[p];
+            ++counters.dispatched;
+            counters.totalWaitMs += m_dispatchClock.elapsed() - item.enqueuedMs;
+
+            ++m_inFlight;
+            m_inFlightItems.insert(item.requestId, item);
+
+            //nowy dekoder przy każdej wysyłce - przerwane żądanie masowe zaczyna od początku
+            std::shared_ptr<MeasurementDecoder> decoder;
+            if (item.streamSensorId > 0) {
+                decoder = std::make_shared<MeasurementDecoder>(item.streamSensorId);
+            }
+
+            NetworkWorker *worker = m_worker;
+            QMetaObject::invokeMethod(worker, [worker, requestId = item.requestId, request = item.request, decoder]() {
+                worker->get(requestId, request, decoder);
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+ApiHandler::CancelFlag ApiHandler::beginRequest(const QString &key) {
+    CancelFlag cancelled = std::make_shared<std::atomic_bool>(false);
+    m_requestFlags.insert(key, cancelled);
+    return cancelled;
+}
+
+bool ApiHandler::finishRequest(const QString &key, const CancelFlag &cancelled) {
+    //porzucone żądanie - odbiorcy zostali już usunięci, klucz może należeć do nowego żądania
+    if (cancelled->load()) return false;
+
+    auto it = m_requestFlags.find(key);
+    if (it != m_requestFlags.end() && it.value() == cancelled) {
+        m_requestFlags.erase(it);
+    }
+    return true;
+}
+
+void ApiHandler::abandonRequest(const QString &key) {
+    //zatrzymuje parsowanie w puli i blokuje przekazanie wyniku
+    CancelFlag cancelled = m_requestFlags.take(key);
+    if (cancelled) {
+        cancelled->store(true);
+    }
+
+    auto idIt = m_requestIdsByKey.find(key);
+    if (idIt == m_requestIdsByKey.end()) return; //odpowiedź już dotarła
+    const quint64 requestId = idIt.value();
+    m_requestIdsByKey.erase(idIt);
+
+    //żądanie jeszcze w kolejce - usuwamy bez wysyłania
+    for (auto &queue : m_dispatchQueues) {
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue[i].requestId == requestId) {
+                queue.removeAt(i);
+                m_pendingRequests.remove(requestId);
+                return;
+            }
+        }
+    }
+
+    //żądanie w locie - przerywamy transfer
+    if (m_inFlightItems.contains(requestId)) {
+        m_cancelledRequests.insert(requestId);
+        m_preempted.remove(requestId);
+
+        NetworkWorker *worker = m_worker;
+        QMetaObject::invokeMethod(worker, [worker, requestId]() {
+            worker->abort(requestId);
+        }, Qt::QueuedConnection);
+    }
+}
+
+bool ApiHandler::preemptBulkRequest() {
+    //najpóźniej wysłane żądanie ma najmniej pobranych danych do stracenia
+    quint64 victim = 0;
+    for (auto it = m_inFlightItems.cbegin(); it != m_inFlightItems.cend(); ++it) {
+        if (it->priority == RequestPriority::Bulk && !m_preempted.contains(it.key()) && it.key() > victim) {
+            victim = it.key();
+        }
+    }
+    if (victim == 0) return false;
+
+    m_preempted.insert(victim);
+    ++m_queueCounters[int(RequestPriority::Bulk)].preempted;
+
+    NetworkWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, victim]() {
+        worker->abort(victim);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void ApiHandler::promoteRequest(const QString &key, RequestPriority priority) {
+    auto idIt = m_requestIdsByKey.constFind(key);
+    if (idIt == m_requestIdsByKey.constEnd()) return;
+    const quint64 requestId = idIt.value();
+
+    //żądanie w locie - chronimy je przed przerwaniem
+    auto flightIt = m_inFlightItems.find(requestId);
+    if (flightIt != m_inFlightItems.end()) {
+        if (int(priority) < int(flightIt->priority)) flightIt->priority = priority;
+        return;
+    }
+
+    for (int p = int(priority) + 1; p < PriorityCount; ++p) {
+        QQueue<DispatchItem> &queue = m_dispatchQueues[p];
+        for (int i = 0; i < queue.size(); ++i) {
+            if (queue[i].requestId != requestId) continue;
+
+            DispatchItem item = queue.takeAt(i);
+            item.priority = priority;
+            m_dispatchQueues[int(priority)].enqueue(item);
+            dispatchPending();
+            return;
+        }
+    }
+}
+
+ApiHandler::QueueStats ApiHandler::queueStats(RequestPriority priority) const {
+    const QQueue<DispatchItem> &queue = m_dispatchQueues[int(priority)];
+    const QueueCounters &counters = m_queueCounters[int(priority)];
+
+    QueueStats stats;
+    stats.depth = queue.size();
+    stats.oldestWaitMs = queue.isEmpty() ? 0 : m_dispatchClock.elapsed() - queue.head().enqueuedMs;
+    stats.averageWaitMs = counters.dispatched > 0 ? double(counters.totalWaitMs) / counters.dispatched : 0.0;
+    stats.dispatched = counters.dispatched;
+    stats.preempted = counters.preempted;
+    return stats;
+}
+
+void ApiHandler::recordTraffic(const NetworkResponse &response) {
+    //świeży wpis z pamięci podręcznej nie dotarł do serwera - nie mówi nic o jego obciążeniu
+    if (response.fromCache && !response.revalidated) return;
+
+    const bool timedOut = response.error == QNetworkReply::TimeoutError ||
+                          response.error == QNetworkReply::OperationCanceledError;
+
+    if (response.httpStatus == 429 || response.httpStatus >= 500 || timedOut) {
+        m_traffic.recordCongestion();
+    } else if (response.httpStatus > 0) {
+        m_traffic.recordSuccess(response.elapsedMs);
+    }
+}
+
+void ApiHandler::handleNetworkResponse(const NetworkResponse &response) {
+    --m_inFlight;
+    DispatchItem item = m_inFlightItems.take(response.requestId);
+
+    //anulowane żądanie - handler usuwamy bez wywołania, błąd przerwania nie świadczy o przeciążeniu
+    if (m_cancelledRequests.remove(response.requestId)) {
+        m_pendingRequests.remove(response.requestId);
+        dispatchPending();
         return;
     }
 
-    //wysyłamy jedną standardową wiadomość
-    emit networkError("connection_error");
-    reply->deleteLater();
-    m_isBusy = false;
+    //przerwane żądanie masowe wraca na początek swojej kolejki
+    if (m_preempted.remove(response.requestId) &&
+        response.error == QNetworkReply::OperationCanceledError) {
+        m_dispatchQueues[int(item.priority)].prepend(item);
+        dispatchPending();
+        return;
+    }
+
+    if (m_requestIdsByKey.value(item.key) == response.requestId) {
+        m_requestIdsByKey.remove(item.key);
+    }
+    recordTraffic(response);
+
+    ResponseHandler handler = m_pendingRequests.take(response.requestId);
+    if (handler) {
+        handler(response);
+    }
+
+    dispatchPending();
+}
+
+bool ApiHandler::handleError(const NetworkResponse &response) {
+    if (response.error == QNetworkReply::NoError) {
+        return true;
+    }
+
+    //jedna standardowa wiadomość dla błędów połączenia
+    if (response.error == QNetworkReply::HostNotFoundError ||
+        response.error == QNetworkReply::ConnectionRefusedError) {
+        emit networkError("connection_error");
+    } else {
+        emit apiError(response.errorString);
+    }
+    return false;
 }
 
 void ApiHandler::setApiUrl(const QString &url) {
@@ -516,8 +1045,13 @@ bool ApiHandler::isInternetAvailable() const {
 
 
 void ApiHandler::updateStations(const QVector<Station>& stations) {
+    //indeksy budujemy poza sekcją krytyczną
+    StationIndex index(stations);
+    StationSearchIndex search(stations);
     QMutexLocker locker(&m_dataMutex);
     m_allStations = stations;
+    m_stationIndex = std::move(index);
+    m_stationSearch = std::move(search);
 }
 
 QVector<Station> ApiHandler::getAllStations() const {
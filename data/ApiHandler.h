@@ -14,55 +14,159 @@
 #include "DatabaseManager.h"
 #include "Sensor.h"
 #include "Measurement.h"
+#include "AnomalyDetector.h"
 #include "AirQualityIndex.h"
+#include "NetworkWorker.h"
+#include "RequestCoalescer.h"
+#include "RequestHandle.h"
+#include "TrafficController.h"
+#include "StationIndex.h"
+#include "StationSearchIndex.h"
 #include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
 
 /**
  * @class ApiHandler
  * @brief Klasa zarządzająca komunikacją z API jakości powietrza
  *
  * Klasa obsługuje pobieranie danych ze stacji pomiarowych, czujników, pomiarów
- * oraz wskaźników jakości powietrza. Wykorzystuje wielowątkowość do efektywnego
- * zarządzania żądaniami sieciowymi.
+ * oraz wskaźników jakości powietrza. Cały ruch sieciowy odbywa się w dedykowanym
+ * wątku (NetworkWorker) bez blokowania, a pula wątków służy wyłącznie do
+ * parsowania odpowiedzi. Tempo i równoległość żądań reguluje TrafficController,
+ * a kolejność wysyłki - klasy priorytetu (interaktywne przed pobieraniem w tle).
  */
 class ApiHandler : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * @enum RequestPriority
+     * @brief Klasa priorytetu żądania
+     */
+    enum class RequestPriority {
+        Interactive = 0,    /**< Akcja użytkownika - przejmuje miejsca żądań masowych */
+        Prefetch,           /**< Wstępne pobieranie danych, które mogą być zaraz potrzebne */
+        Bulk                /**< Pełna aktualizacja w tle */
+    };
+
+    /**
+     * @struct QueueStats
+     * @brief Statystyki kolejki jednej klasy priorytetu
+     */
+    struct QueueStats {
+        int depth = 0;                  /**< Liczba żądań oczekujących */
+        qint64 oldestWaitMs = 0;        /**< Czas oczekiwania najstarszego żądania */
+        double averageWaitMs = 0.0;     /**< Średni czas oczekiwania wysłanych żądań */
+        quint64 dispatched = 0;         /**< Liczba wysłanych żądań */
+        quint64 preempted = 0;          /**< Liczba żądań przerwanych na rzecz interaktywnych */
+    };
+
     /**
      * @brief Konstruktor klasy ApiHandler
      * @param parent Wskaźnik na obiekt rodzica (domyślnie nullptr)
      */
     explicit ApiHandler(QObject *parent = nullptr);
 
+    /**
+     * @brief Destruktor klasy ApiHandler
+     *
+     * Zatrzymuje wątek sieciowy i czeka na zakończenie zadań parsowania
+     */
+    ~ApiHandler();
+
     // Główne metody API
 
     /**
      * @brief Pobiera listę wszystkich stacji pomiarowych
+     * @param priority Klasa priorytetu żądania
+     * @return Uchwyt anulowania (trwające pobieranie zwraca swój uchwyt)
      */
-    void fetchStations();
+    RequestHandle fetchStations(RequestPriority priority = RequestPriority::Interactive);
 
     /**
      * @brief Pobiera listę czujników dla określonej stacji
      * @param stationId ID stacji
+     * @param priority Klasa priorytetu żądania
+     * @return Uchwyt anulowania
+     *
+     * Anuluje poprzednie pobieranie czujników - sygnał sensorsFetched dotyczy tylko ostatniego wywołania
      */
-    void fetchSensors(int stationId);
+    RequestHandle fetchSensors(int stationId, RequestPriority priority = RequestPriority::Interactive);
 
     /**
      * @brief Pobiera pomiary z określonego czujnika
      * @param sensorId ID czujnika
      * @param from Data początkowa zakresu (opcjonalna)
      * @param to Data końcowa zakresu (opcjonalna)
+     * @param priority Klasa priorytetu żądania
+     * @return Uchwyt anulowania
+     *
+     * Anuluje poprzednie pobieranie pomiarów - sygnał measurementsFetched dotyczy tylko ostatniego wywołania
      */
-    void fetchMeasurements(int sensorId,
-                           const QDateTime& from = QDateTime(),
-                           const QDateTime& to = QDateTime());
+    RequestHandle fetchMeasurements(int sensorId,
+                                    const QDateTime& from = QDateTime(),
+                                    const QDateTime& to = QDateTime(),
+                                    RequestPriority priority = RequestPriority::Interactive);
 
     /**
      * @brief Pobiera wskaźnik jakości powietrza dla stacji
      * @param stationId ID stacji
+     * @param priority Klasa priorytetu żądania
+     * @return Uchwyt anulowania
+     *
+     * Anuluje poprzednie pobieranie indeksu - sygnał airQualityIndexFetched dotyczy tylko ostatniego wywołania
+     */
+    RequestHandle fetchAirQualityIndex(int stationId, RequestPriority priority = RequestPriority::Interactive);
+
+    /**
+     * @brief Anuluje żądanie - wynik nie zostanie przekazany
+     * @param handle Uchwyt zwrócony przez metodę fetch
+     *
+     * Jeśli nikt inny nie czeka na ten zasób, żądanie jest usuwane z kolejki lub
+     * przerywane w locie, a parsowanie zatrzymywane
+     */
+    void cancel(const RequestHandle &handle);
+
+    /**
+     * @brief Zwraca statystyki kolejki żądań danej klasy priorytetu
+     * @param priority Klasa priorytetu
+     * @return Głębokość kolejki i czasy oczekiwania
+     */
+    QueueStats queueStats(RequestPriority priority) const;
+
+    // Tryb crawl
+
+    /**
+     * @brief Pobiera pełny stan sieci: stacje, czujniki, indeksy i pomiary wszystkich czujników
+     * @param maxConcurrent Maksymalna liczba jednoczesnych żądań (0 - limit adaptacyjny)
+     *
+     * Wyniki są zapisywane do bazy danych pakietami, postęp raportuje sygnał crawlProgress
      */
-    void fetchAirQualityIndex(int stationId);
+    void startCrawl(int maxConcurrent = 0);
+
+    /**
+     * @brief Uruchamia cykliczną pełną aktualizację (pierwsza natychmiast)
+     * @param intervalMs Odstęp między aktualizacjami (domyślnie godzina)
+     * @param maxConcurrent Maksymalna liczba jednoczesnych żądań (0 - limit adaptacyjny)
+     */
+    void startPeriodicCrawl(int intervalMs = 3600000, int maxConcurrent = 0);
+
+    /**
+     * @brief Zatrzymuje cykliczną pełną aktualizację (bieżąca zostaje dokończona)
+     */
+    void stopPeriodicCrawl();
+
+    /**
+     * @brief Sprawdza, czy trwa pełna aktualizacja
+     * @return true jeśli trwa pełna aktualizacja
+     */
+    bool isCrawling() const { return m_crawl.running; }
 
     // Metody pomocnicze
 
@@ -80,18 +184,37 @@ public:
 
     /**
      * @brief Filtruje stacje według miasta
-     * @param city Nazwa miasta
+     * @param city Nazwa miasta (wielkość liter i polskie znaki nie mają znaczenia)
+     * @note Wynik pochodzi z indeksu wyszukiwania, bez przeglądania wszystkich stacji
      */
     void filterStationsByCity(const QString& city);
 
+    /**
+     * @brief Wyszukuje stacje po nazwie i adresie
+     * @param query Zapytanie (np. "lodz czerni" znajdzie "Łódź, ul. Czernika")
+     * @param limit Maksymalna liczba wyników (0 - bez limitu)
+     * @return Stacje od najlepiej dopasowanej
+     */
+    QVector<Station> searchStations(const QString& query, int limit = 0) const;
+
     /**
      * @brief Znajduje stacje w określonym promieniu od współrzędnych
      * @param lat Szerokość geograficzna
      * @param lon Długość geograficzna
      * @param radiusKm Promień w kilometrach
+     * @note Wynik (od najbliższej stacji) pochodzi z indeksu przestrzennego
      */
     void findStationsInRadius(double lat, double lon, double radiusKm);
 
+    /**
+     * @brief Zwraca najbliższe stacje
+     * @param lat Szerokość geograficzna
+     * @param lon Długość geograficzna
+     * @param count Liczba stacji
+     * @return Stacje uporządkowane od najbliższej
+     */
+    QVector<Station> nearestStations(double lat, double lon, int count) const;
+
     /**
      * @brief Znajduje stacje w pobliżu adresu
      * @param address Adres do geokodowania
@@ -106,7 +229,7 @@ public:
     DatabaseManager* databaseManager() const { return m_dbManager; }
 
     /**
-     * @brief Aktualizuje listę stacji
+     * @brief Aktualizuje listę stacji i przebudowuje indeks przestrzenny
      * @param stations Nowa lista stacji
      */
     void updateStations(const QVector<Station>& stations);
@@ -165,6 +288,21 @@ signals:
      */
     void geocodingFinished(double latitude, double longitude);
 
+    /**
+     * @brief Sygnał emitowany po każdym zakończonym zadaniu pełnej aktualizacji
+     * @param completed Liczba zakończonych zadań
+     * @param total Liczba znanych zadań (rośnie wraz z odkrywaniem czujników)
+     */
+    void crawlProgress(int completed, int total);
+
+    /**
+     * @brief Sygnał emitowany po zakończeniu pełnej aktualizacji
+     * @param stations Liczba stacji
+     * @param sensors Liczba zapisanych czujników
+     * @param failed Liczba nieudanych zadań
+     */
+    void crawlFinished(int stations, int sensors, int failed);
+
     // Sygnały błędów
 
     /**
@@ -186,46 +324,137 @@ signals:
     void geocodingError(const QString& message);
 
 private slots:
-    /**
-     * @brief Slot obsługujący odpowiedź z listą stacji
-     */
-    void handleStationsReply();
-
-    /**
-     * @brief Slot obsługujący odpowiedź z listą czujników
-     */
-    void handleSensorsReply();
-
-    /**
-     * @brief Slot obsługujący odpowiedź z pomiarami
-     */
-    void handleMeasurementsReply();
-
-    /**
-     * @brief Slot obsługujący odpowiedź ze wskaźnikiem jakości powietrza
-     */
-    void handleAirQualityIndexReply();
-
     /**
      * @brief Slot obsługujący odpowiedź geokodowania
      */
     void handleGeocodingReply();
 
     /**
-     * @brief Slot obsługujący błędy sieciowe
-     * @param code Kod błędu
+     * @brief Slot przekazujący zakończone żądanie do zarejestrowanego handlera
+     * @param response Wynik żądania z wątku sieciowego
      */
-    void handleNetworkError(QNetworkReply::NetworkError code);
+    void handleNetworkResponse(const NetworkResponse &response);
 
 private:
-    QNetworkAccessManager m_manager;                 /**< Menedżer połączeń sieciowych */
+    using ResponseHandler = std::function<void(const NetworkResponse&)>;
+    using StationsCallback = std::function<void(bool, const QVector<Station>&)>;
+    using SensorsCallback = std::function<void(bool, const QVector<Sensor>&)>;
+    using MeasurementCallback = std::function<void(bool, const Measurement&)>;
+    using IndexCallback = std::function<void(bool, const AirQualityIndex&)>;
+    using CancelFlag = std::shared_ptr<std::atomic_bool>;
+
+    /**
+     * @struct CrawlTask
+     * @brief Pojedyncze zadanie pełnej aktualizacji
+     */
+    struct CrawlTask {
+        enum Kind { Sensors, Data } kind;        /**< Rodzaj endpointu */
+        int id;                                  /**< ID stacji lub czujnika */
+    };
+
+    /**
+     * @struct CrawlState
+     * @brief Stan bieżącej pełnej aktualizacji
+     */
+    struct CrawlState {
+        bool running = false;                    /**< Czy trwa aktualizacja */
+        int maxConcurrent = 0;                   /**< Limit jednoczesnych żądań (0 - adaptacyjny) */
+        int inFlight = 0;                        /**< Liczba żądań w locie */
+        int completed = 0;                       /**< Liczba zakończonych zadań */
+        int total = 0;                           /**< Liczba znanych zadań */
+        int failed = 0;                          /**< Liczba nieudanych zadań */
+        int stations = 0;                        /**< Liczba stacji */
+        int sensorCount = 0;                     /**< Liczba zapisanych czujników */
+        QQueue<CrawlTask> queue;                 /**< Zadania oczekujące */
+        QVector<Station> pendingStations;        /**< Stacje oczekujące na zapis */
+        QVector<Sensor> sensors;                 /**< Czujniki oczekujące na zapis */
+        qint64 oldestNewTime = Measurement::InvalidTime; /**< Najstarszy nowy pomiar (sekundy od epoki) */
+    };
+
+    /**
+     * @struct ParsedResponse
+     * @brief Sparsowany wynik odpowiedzi zapamiętany razem z walidatorem treści
+     *
+     * Gdy odpowiedź pochodzi z pamięci podręcznej HTTP z tym samym walidatorem,
+     * wynik jest przekazywany bez ponownego parsowania
+     */
+    template <typename T>
+    struct ParsedResponse {
+        QByteArray validator;                    /**< ETag lub Last-Modified treści */
+        T value;                                 /**< Sparsowany wynik */
+    };
+
+    /**
+     * @struct DispatchItem
+     * @brief Żądanie oczekujące na zgodę kontrolera ruchu
+     */
+    struct DispatchItem {
+        quint64 requestId = 0;                   /**< Identyfikator żądania */
+        QNetworkRequest request;                 /**< Obiekt żądania */
+        QString key;                             /**< Znormalizowany URL żądania */
+        RequestPriority priority = RequestPriority::Bulk; /**< Klasa priorytetu */
+        qint64 enqueuedMs = 0;                   /**< Czas dodania do kolejki */
+        int streamSensorId = 0;                  /**< ID czujnika dla dekodowania strumieniowego (0 - treść buforowana) */
+    };
+
+    /**
+     * @struct QueueCounters
+     * @brief Liczniki kolejki jednej klasy priorytetu
+     */
+    struct QueueCounters {
+        quint64 dispatched = 0;                  /**< Liczba wysłanych żądań */
+        qint64 totalWaitMs = 0;                  /**< Suma czasów oczekiwania */
+        quint64 preempted = 0;                   /**< Liczba przerwanych żądań */
+    };
+
+    static constexpr int PriorityCount = 3;      /**< Liczba klas priorytetu */
+
+    static constexpr int CrawlBatchSize = 50;    /**< Liczba wyników zapisywanych w jednej transakcji */
+    static constexpr int SyncWindowHours = 72;   /**< Szerokość okna historii zwracanego po synchronizacji */
+    static constexpr int DetectorSeedDays = 7;   /**< Historia z bazy odtwarzana przy tworzeniu detektora anomalii */
+
+    QThread m_networkThread;                        /**< Dedykowany wątek ruchu sieciowego */
+    NetworkWorker *m_worker;                        /**< Obiekt wykonujący żądania w wątku sieciowym */
+    QHash<quint64, ResponseHandler> m_pendingRequests; /**< Handlery żądań oczekujących na odpowiedź */
+    TrafficController m_traffic;                    /**< Adaptacyjny limit tempa i równoległości */
+    QQueue<DispatchItem> m_dispatchQueues[PriorityCount]; /**< Żądania oczekujące na wysłanie według priorytetu */
+    QueueCounters m_queueCounters[PriorityCount];   /**< Liczniki kolejek według priorytetu */
+    QHash<quint64, DispatchItem> m_inFlightItems;   /**< Żądania wysłane do wątku sieciowego */
+    QSet<quint64> m_preempted;                      /**< Żądania przerywane na rzecz interaktywnych */
+    QHash<QString, quint64> m_requestIdsByKey;      /**< Identyfikator żądania według znormalizowanego URL */
+    QElapsedTimer m_dispatchClock;                  /**< Zegar czasów oczekiwania w kolejkach */
+    QHash<QString, CancelFlag> m_requestFlags;      /**< Znaczniki porzucenia żądań według klucza */
+    QSet<quint64> m_cancelledRequests;              /**< Żądania przerywane po anulowaniu */
+    RequestHandle m_stationsFetch;                  /**< Ostatnie pobieranie stacji dla UI */
+    RequestHandle m_sensorsFetch;                   /**< Ostatnie pobieranie czujników dla UI */
+    RequestHandle m_measurementsFetch;              /**< Ostatnie pobieranie pomiarów dla UI */
+    RequestHandle m_indexFetch;                     /**< Ostatnie pobieranie indeksu dla UI */
+    int m_inFlight = 0;                             /**< Liczba żądań wysłanych do wątku sieciowego */
+    QTimer m_dispatchTimer;                         /**< Zegar wznawiający wysyłkę po odnowieniu tokenu */
+    quint64 m_nextRequestId = 1;                    /**< Kolejny identyfikator żądania */
     QString m_apiBaseUrl = "https://api.gios.gov.pl/pjp-api/rest"; /**< Bazowy URL API */
     bool m_isBusy = false;                          /**< Flaga wskazująca czy trwa przetwarzanie żądania */
     QVector<Station> m_allStations;                 /**< Cache wszystkich stacji */
+    StationIndex m_stationIndex;                    /**< Indeks przestrzenny m_allStations */
+    StationSearchIndex m_stationSearch;             /**< Indeks tekstowy m_allStations */
     QNetworkAccessManager m_geocoderManager;        /**< Menedżer połączeń dla geokodowania */
     DatabaseManager *m_dbManager;                   /**< Wskaźnik do menedżera bazy danych */
-    QThreadPool m_threadPool;                       /**< Pula wątków dla operacji asynchronicznych */
+    QThreadPool m_threadPool;                       /**< Pula wątków do parsowania odpowiedzi */
     mutable QMutex m_dataMutex;                     /**< Mutex do synchronizacji dostępu do danych */
+    CrawlState m_crawl;                             /**< Stan pełnej aktualizacji */
+    QTimer *m_crawlTimer = nullptr;                 /**< Zegar cyklicznej pełnej aktualizacji */
+    int m_crawlConcurrency = 0;                     /**< Równoległość cyklicznej aktualizacji */
+    QElapsedTimer m_crawlElapsed;                   /**< Czas trwania bieżącej aktualizacji */
+    QHash<int, QDateTime> m_highWaterMarks;         /**< Czas najnowszego przyjętego pomiaru według czujnika */
+    QHash<int, AnomalyDetector> m_detectors;        /**< Stan detektora anomalii według czujnika */
+    QVector<Measurement> m_pendingMeasurements;     /**< Przyjęte nowe punkty oczekujące na zapis */
+    RequestCoalescer<QVector<Station>> m_stationsRequests;   /**< Żądania listy stacji w locie */
+    RequestCoalescer<QVector<Sensor>> m_sensorsRequests;     /**< Żądania czujników w locie */
+    RequestCoalescer<Measurement> m_measurementsRequests;    /**< Żądania pomiarów w locie */
+    RequestCoalescer<AirQualityIndex> m_indexRequests;       /**< Żądania indeksów w locie */
+    QHash<QString, ParsedResponse<QVector<Station>>> m_parsedStations; /**< Sparsowane listy stacji według URL */
+    QHash<QString, ParsedResponse<QVector<Sensor>>> m_parsedSensors;   /**< Sparsowane czujniki według URL */
+    QHash<QString, ParsedResponse<AirQualityIndex>> m_parsedIndices;   /**< Sparsowane indeksy według URL */
 
     // Metody prywatne
 
@@ -243,11 +472,84 @@ private:
      */
     QNetworkRequest createRequest(const QUrl &url) const;
 
+    /**
+     * @brief Tworzy klucz żądania ze znormalizowanego URL (posortowane parametry, bez fragmentu)
+     * @param url URL żądania
+     * @return Klucz używany do łączenia równoczesnych żądań
+     */
+    static QString normalizedUrlKey(const QUrl &url);
+
+    /**
+     * @brief Wysyła nieblokujące żądanie GET przez wątek sieciowy
+     * @param url URL żądania
+     * @param handler Funkcja wywoływana w wątku głównym po otrzymaniu odpowiedzi
+     * @param priority Klasa priorytetu żądania
+     * @param cacheable Czy odpowiedź może być zapisana w pamięci podręcznej HTTP
+     * @param streamSensorId ID czujnika, gdy odpowiedź data/getData ma być dekodowana
+     *                       w trakcie pobierania (0 - treść buforowana w całości)
+     * @return Identyfikator żądania
+     */
+    quint64 sendRequest(const QUrl &url, ResponseHandler handler, RequestPriority priority,
+                        bool cacheable = true, int streamSensorId = 0);
+
+    /**
+     * @brief Podnosi priorytet oczekującego żądania (gdy dołącza do niego wywołujący o wyższym priorytecie)
+     * @param key Znormalizowany URL żądania
+     * @param priority Nowa klasa priorytetu
+     */
+    void promoteRequest(const QString &key, RequestPriority priority);
+
+    /**
+     * @brief Rejestruje znacznik porzucenia nowego żądania
+     * @param key Znormalizowany URL żądania
+     * @return Znacznik sprawdzany w wątku głównym i w puli wątków
+     */
+    CancelFlag beginRequest(const QString &key);
+
+    /**
+     * @brief Kończy żądanie przed przekazaniem wyniku odbiorcom
+     * @param key Znormalizowany URL żądania
+     * @param cancelled Znacznik zwrócony przez beginRequest
+     * @return false jeśli żądanie porzucono i wyniku nie należy przekazywać
+     */
+    bool finishRequest(const QString &key, const CancelFlag &cancelled);
+
+    /**
+     * @brief Porzuca żądanie: usuwa je z kolejki lub przerywa w locie i zatrzymuje parsowanie
+     * @param key Znormalizowany URL żądania
+     */
+    void abandonRequest(const QString &key);
+
+    /**
+     * @brief Przerywa najpóźniej wysłane żądanie masowe, aby zwolnić miejsce dla interaktywnego
+     * @return true jeśli przerwano żądanie
+     */
+    bool preemptBulkRequest();
+
+    /**
+     * @brief Zamienia klasę priorytetu żądania na priorytet zadania w puli wątków
+     * @param priority Klasa priorytetu
+     * @return Priorytet QThreadPool (wyższy wykonywany wcześniej)
+     */
+    static int poolPriority(RequestPriority priority) { return PriorityCount - 1 - int(priority); }
+
+    /**
+     * @brief Wysyła oczekujące żądania w granicach limitów kontrolera ruchu
+     */
+    void dispatchPending();
+
+    /**
+     * @brief Przekazuje wynik żądania do kontrolera ruchu
+     * @param response Wynik żądania
+     */
+    void recordTraffic(const NetworkResponse &response);
+
     /**
      * @brief Obsługuje błędy sieciowe
-     * @param reply Obiekt odpowiedzi
+     * @param response Wynik żądania
+     * @return true jeśli odpowiedź jest poprawna, false jeśli zgłoszono błąd
      */
-    void handleError(QNetworkReply *reply);
+    bool handleError(const NetworkResponse &response);
 
     /**
      * @brief Parsuje odpowiedź w formacie JSON array
@@ -269,26 +571,203 @@ private:
      */
     void performGeocoding(const QString& address);
 
+    /**
+     * @brief Pobiera listę stacji i przekazuje ją do callbacku
+     * @param priority Klasa priorytetu żądania
+     * @param callback Funkcja wywoływana w wątku głównym z wynikiem
+     * @param handle Uchwyt anulowania odbiorcy
+     */
+    void requestStations(RequestPriority priority, StationsCallback callback,
+                         const RequestHandle &handle = RequestHandle());
+
+    /**
+     * @brief Pobiera czujniki stacji i przekazuje je do callbacku
+     * @param stationId ID stacji
+     * @param priority Klasa priorytetu żądania
+     * @param callback Funkcja wywoływana w wątku głównym z wynikiem
+     * @param handle Uchwyt anulowania odbiorcy
+     */
+    void requestSensors(int stationId, RequestPriority priority, SensorsCallback callback,
+                        const RequestHandle &handle = RequestHandle());
+
+    /**
+     * @brief Pobiera pomiary czujnika i przekazuje je do callbacku
+     * @param sensorId ID czujnika
+     * @param from Data początkowa zakresu
+     * @param to Data końcowa zakresu
+     * @param priority Klasa priorytetu żądania
+     * @param callback Funkcja wywoływana w wątku głównym z wynikiem
+     * @param handle Uchwyt anulowania odbiorcy
+     */
+    void requestMeasurements(int sensorId, const QDateTime& from, const QDateTime& to,
+                             RequestPriority priority, MeasurementCallback callback,
+                             const RequestHandle &handle = RequestHandle());
+
+    /**
+     * @brief Pobiera tylko pomiary nowsze niż zapisane w bazie, zapisuje je i scala z historią
+     * @param sensorId ID czujnika
+     * @param priority Klasa priorytetu żądania
+     * @param callback Funkcja wywoływana w wątku głównym ze scaloną serią
+     * @param handle Uchwyt anulowania odbiorcy
+     */
+    void syncMeasurements(int sensorId, RequestPriority priority, MeasurementCallback callback,
+                          const RequestHandle &handle = RequestHandle());
+
+    /**
+     * @brief Zwraca czas najnowszego przyjętego poprawnego pomiaru czujnika
+     * @param sensorId ID czujnika
+     * @return High-water mark (odczytywany z bazy przy pierwszym użyciu)
+     */
+    QDateTime measurementHighWaterMark(int sensorId);
+
+    /**
+     * @brief Przyjmuje punkty odpowiedzi nowsze niż high-water mark czujnika
+     * @param fresh Seria z odpowiedzi API
+     * @return Nowe punkty z oznaczonymi anomaliami (pusta seria, gdy przyjął je już inny odbiorca)
+     *
+     * Ta sama odpowiedź trafia do wszystkich połączonych odbiorców, więc detekcja i zapis
+     * odbywają się tylko przy pierwszym przyjęciu. High-water mark przesuwa się od razu,
+     * a punkty czekają w buforze na storePendingMeasurements()
+     */
+    Measurement acceptNewMeasurements(const Measurement &fresh);
+
+    /**
+     * @brief Zapisuje przyjęte punkty oczekujące w buforze
+     *
+     * Po nieudanym zapisie high-water marki i detektory czujników są odtwarzane z bazy danych
+     */
+    void storePendingMeasurements();
+
+    /**
+     * @brief Oznacza anomalie w nowych punktach serii detektorem jej czujnika
+     * @param measurement Seria zawierająca wyłącznie nowe punkty
+     *
+     * Detektor czujnika powstaje przy pierwszym użyciu i jest rozgrzewany historią z bazy danych
+     */
+    void flagAnomalies(Measurement &measurement);
+
+    /**
+     * @brief Pobiera indeks jakości powietrza i przekazuje go do callbacku
+     * @param stationId ID stacji
+     * @param priority Klasa priorytetu żądania
+     * @param callback Funkcja wywoływana w wątku głównym z wynikiem
+     * @param handle Uchwyt anulowania odbiorcy
+     */
+    void requestAirQualityIndex(int stationId, RequestPriority priority, IndexCallback callback,
+                                const RequestHandle &handle = RequestHandle());
+
+    /**
+     * @brief Przekazuje wynik parsowania z puli wątków do wątku głównego
+     * @param callback Funkcja docelowa
+     * @param ok Czy parsowanie się powiodło
+     * @param value Wynik parsowania
+     */
+    template <typename T>
+    void deliverResult(const std::function<void(bool, const T&)> &callback, bool ok, const T &value) {
+        QMetaObject::invokeMethod(this, [callback, ok, value]() {
+            callback(ok, value);
+        }, Qt::QueuedConnection);
+    }
+
+    /**
+     * @brief Przekazuje zapamiętany wynik, jeśli odpowiedź z pamięci podręcznej ma ten sam walidator
+     * @param parsed Zapamiętane wyniki według klucza
+     * @param key Klucz żądania
+     * @param response Wynik żądania
+     * @param callback Funkcja odbierająca wynik
+     * @return true jeśli wynik przekazano bez parsowania
+     */
+    template <typename T>
+    bool reuseParsed(const QHash<QString, ParsedResponse<T>> &parsed, const QString &key,
+                     const NetworkResponse &response, const std::function<void(bool, const T&)> &callback) {
+        if (!response.fromCache || response.validator.isEmpty()) return false;
+
+        auto it = parsed.constFind(key);
+        if (it == parsed.constEnd() || it->validator != response.validator) return false;
+
+        callback(true, it->value);
+        return true;
+    }
+
+    /**
+     * @brief Opakowuje callback tak, aby zapamiętał wynik parsowania odpowiedzi
+     * @param parsed Zapamiętane wyniki według klucza
+     * @param key Klucz żądania
+     * @param validator Walidator parsowanej treści
+     * @param callback Funkcja odbierająca wynik
+     * @return Callback zapisujący poprawny wynik przed przekazaniem go dalej
+     */
+    template <typename T>
+    std::function<void(bool, const T&)> rememberParsed(QHash<QString, ParsedResponse<T>> &parsed, const QString &key,
+                                                       const QByteArray &validator,
+                                                       std::function<void(bool, const T&)> callback) {
+        if (validator.isEmpty()) return callback;
+
+        return [&parsed, key, validator, callback](bool ok, const T &value) {
+            if (ok) parsed.insert(key, {validator, value});
+            callback(ok, value);
+        };
+    }
+
     /**
      * @brief Implementacja obsługi odpowiedzi z stacjami
-     * @param reply Obiekt odpowiedzi
+     * @param body Treść odpowiedzi
+     * @param callback Funkcja odbierająca wynik
      */
-    void handleStationsReplyImpl(QNetworkReply* reply);
+    void handleStationsReplyImpl(const QByteArray& body, StationsCallback callback);
 
     /**
      * @brief Implementacja obsługi odpowiedzi z czujnikami
-     * @param reply Obiekt odpowiedzi
+     * @param body Treść odpowiedzi
+     * @param callback Funkcja odbierająca wynik
      */
-    void handleSensorsReplyImpl(QNetworkReply* reply);
+    void handleSensorsReplyImpl(const QByteArray& body, SensorsCallback callback);
 
     /**
      * @brief Implementacja obsługi odpowiedzi z pomiarami
-     * @param reply Obiekt odpowiedzi
+     * @param decoder Dekoder, który otrzymał całą odpowiedź w wątku sieciowym
      * @param sensorId ID czujnika
-     * @param from Data początkowa
-     * @param to Data końcowa
+     * @param callback Funkcja odbierająca wynik
+     */
+    void handleMeasurementsReplyImpl(const std::shared_ptr<MeasurementDecoder>& decoder, int sensorId,
+                                     MeasurementCallback callback);
+
+    /**
+     * @brief Implementacja obsługi odpowiedzi ze wskaźnikiem jakości powietrza
+     * @param body Treść odpowiedzi
+     * @param callback Funkcja odbierająca wynik
+     */
+    void handleAirQualityIndexReplyImpl(const QByteArray& body, IndexCallback callback);
+
+    /**
+     * @brief Uruchamia kolejne zadania pełnej aktualizacji do wyczerpania limitu równoległości
+     */
+    void pumpCrawl();
+
+    /**
+     * @brief Księguje zakończone zadanie pełnej aktualizacji
+     * @param ok Czy zadanie się powiodło
+     */
+    void finishCrawlTask(bool ok);
+
+    /**
+     * @brief Kończy pełną aktualizację - zapisuje bufor, przelicza indeksy i emituje crawlFinished
+     */
+    void completeCrawl();
+
+    /**
+     * @brief Zapisuje zbuforowane wyniki pełnej aktualizacji do bazy danych
+     */
+    void flushCrawlBatch();
+
+    /**
+     * @brief Przelicza indeksy jakości powietrza wszystkich stacji z zapisanych pomiarów
+     *
+     * Zastępuje zapytania aqindex/getIndex w pełnej aktualizacji - indeksy powstają lokalnie.
+     * Godzinowa historia indeksu jest przeliczana od najstarszego nowego pomiaru aktualizacji
+     * (przy pierwszej aktualizacji - dla całej pobranej historii), aktualny indeks z ostatnich godzin
      */
-    void handleMeasurementsReplyImpl(QNetworkReply* reply, int sensorId, const QDateTime& from, const QDateTime& to);
+    void refreshLocalIndices();
 
     /**
      * @brief Sprawdza dostępność internetu
@@ -1,4 +1,31 @@
 #include "DatabaseManager.h"
+#include "TimestampParser.h"
+#include <cmath>
+
+namespace {
+
+//upsert pomiaru - wiersz jest nadpisywany tylko gdy wartość, status lub flagi się zmieniły
+//flagi anomalii są sumowane - ponowny zapis bez detekcji ich nie kasuje
+const char *const MeasurementUpsertSql =
+    "INSERT INTO measurements (sensor_id, timestamp, value, is_valid, flags) VALUES (?, ?, ?, ?, ?) "
+    "ON CONFLICT(sensor_id, timestamp) DO UPDATE SET "
+    "value = excluded.value, is_valid = excluded.is_valid, "
+    "flags = measurements.flags | excluded.flags "
+    "WHERE measurements.is_valid <> excluded.is_valid "
+    "OR measurements.value IS NOT excluded.value "
+    "OR (measurements.flags | excluded.flags) <> measurements.flags";
+
+//dzień pomiaru według kalendarza polskiego (jak dane GIOS) - klucz dziennych szkiców i agregatów
+QString dayOf(qint64 epochSecs) {
+    return QDate(1970, 1, 1).addDays(TimestampParser::warsawDay(epochSecs)).toString(Qt::ISODate);
+}
+
+//północ czasu polskiego podanego dnia jako sekundy UTC
+qint64 dayStart(const QDate &day) {
+    return TimestampParser::warsawToUtc(day.year(), day.month(), day.day(), 0);
+}
+
+}
 
 DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent) {
     initDatabase();
@@ -50,14 +77,68 @@ bool DatabaseManager::createTables() {
                "param_id INTEGER,"
                "FOREIGN KEY(station_id) REFERENCES stations(id))");
 
-    //tabela pomiarów
+    //tabela pomiarów - czas jako sekundy UTC od epoki Unix
     query.exec("CREATE TABLE IF NOT EXISTS measurements ("
                "sensor_id INTEGER,"
-               "timestamp TEXT,"
+               "timestamp INTEGER,"
                "value REAL,"
                "is_valid INTEGER,"
+               "flags INTEGER DEFAULT 0,"
                "FOREIGN KEY(sensor_id) REFERENCES sensors(id))");
 
+    //flagi anomalii - kolumna dodana później, starsze bazy jej nie mają
+    query.exec("SELECT COUNT(*) FROM pragma_table_info('measurements') WHERE name = 'flags'");
+    if (query.next() && query.value(0).toInt() == 0) {
+        query.exec("ALTER TABLE measurements ADD COLUMN flags INTEGER DEFAULT 0");
+    }
+
+    //starsze bazy zapisywały czas jako tekst ISO w czasie lokalnym, bez strefy
+    query.exec("SELECT type FROM pragma_table_info('measurements') WHERE name = 'timestamp'");
+    const bool textTimes = query.next() && query.value(0).toString().compare("TEXT", Qt::CaseInsensitive) == 0;
+    if (textTimes && !migrateMeasurementTimes()) {
+        return false;
+    }
+
+    //unikalny klucz (czujnik, czas) - wymagany przez synchronizację przyrostową
+    query.exec("CREATE UNIQUE INDEX IF NOT EXISTS idx_measurements_sensor_time "
+               "ON measurements(sensor_id, timestamp)");
+
+    //dzienne szkice kwantyli (t-digest) - percentyle bez odczytu surowych pomiarów
+    query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' "
+               "AND name IN ('measurement_sketches', 'measurement_tiers')");
+    //po migracji czasów dni liczone są według kalendarza polskiego - dane pochodne od nowa
+    const bool derivedExist = query.next() && query.value(0).toInt() == 2 && !textTimes;
+    query.exec("CREATE TABLE IF NOT EXISTS measurement_sketches ("
+               "sensor_id INTEGER,"
+               "day TEXT,"
+               "digest BLOB,"
+               "PRIMARY KEY(sensor_id, day))");
+
+    //agregaty dobowe, tygodniowe i miesięczne - długie zakresy bez odczytu surowych pomiarów
+    query.exec("CREATE TABLE IF NOT EXISTS measurement_tiers ("
+               "sensor_id INTEGER,"
+               "tier INTEGER,"
+               "bucket TEXT,"
+               "min REAL,"
+               "max REAL,"
+               "sum REAL,"
+               "count INTEGER,"
+               "PRIMARY KEY(sensor_id, tier, bucket))");
+
+    //czujniki, których dane pochodne trzeba zbudować - budowa przy pierwszym odczycie
+    //czujnika zamiast przy starcie, kolejka przetrwa zamknięcie programu
+    query.exec("CREATE TABLE IF NOT EXISTS derived_pending ("
+               "sensor_id INTEGER PRIMARY KEY)");
+    if (!derivedExist) {
+        query.exec("DELETE FROM measurement_sketches");
+        query.exec("DELETE FROM measurement_tiers");
+        query.exec("INSERT OR IGNORE INTO derived_pending SELECT DISTINCT sensor_id FROM measurements");
+    }
+    query.exec("SELECT sensor_id FROM derived_pending");
+    while (query.next()) {
+        m_pendingDerived.insert(query.value(0).toInt());
+    }
+
     //tabela indeksu jakości powietrza
     query.exec("CREATE TABLE IF NOT EXISTS air_quality ("
                "station_id INTEGER PRIMARY KEY,"
@@ -66,9 +147,112 @@ bool DatabaseManager::createTables() {
                "overall_index_name TEXT,"
                "source_data_date TEXT)");
 
+    //godzinowa historia indeksu ogólnego stacji (czas w sekundach UTC)
+    query.exec("CREATE TABLE IF NOT EXISTS air_quality_history ("
+               "station_id INTEGER,"
+               "timestamp INTEGER,"
+               "index_id INTEGER,"
+               "PRIMARY KEY (station_id, timestamp))");
+
     return !query.lastError().isValid();
 }
 
+bool DatabaseManager::migrateMeasurementTimes() {
+    qDebug() << "Przenoszenie czasów pomiarów na sekundy UTC";
+
+    return runInTransaction([&]() {
+        QSqlQuery query;
+        auto run = [&query](const QString &sql) {
+            if (!query.exec(sql)) {
+                throw std::runtime_error(
+                    QString("Migracja czasów pomiarów nie powiodła się: %1")
+                        .arg(query.lastError().text())
+                        .toStdString());
+            }
+        };
+
+        run("CREATE TABLE measurements_utc ("
+            "sensor_id INTEGER,"
+            "timestamp INTEGER,"
+            "value REAL,"
+            "is_valid INTEGER,"
+            "flags INTEGER DEFAULT 0,"
+            "FOREIGN KEY(sensor_id) REFERENCES sensors(id))");
+
+        QSqlQuery insert;
+        insert.prepare("INSERT INTO measurements_utc VALUES (?, ?, ?, ?, ?)");
+
+        //grupy tego samego zapisu czasu, w grupie od najnowszego wiersza
+        QSqlQuery select;
+        select.setForwardOnly(true);
+        if (!select.exec("SELECT sensor_id, timestamp, value, is_valid, flags FROM measurements "
+                         "ORDER BY sensor_id, timestamp, rowid DESC")) {
+            throw std::runtime_error(
+                QString("Nie udało się odczytać pomiarów do migracji: %1")
+                    .arg(select.lastError().text())
+                    .toStdString());
+        }
+
+        int sensorId = 0;
+        QString text;
+        QVector<qint64> instants;
+        int used = 0;
+        int dropped = 0;
+        while (select.next()) {
+            const int rowSensor = select.value(0).toInt();
+            const QString rowText = select.value(1).toString();
+            if (used == 0 || rowSensor != sensorId || rowText != text) {
+                sensorId = rowSensor;
+                text = rowText;
+                used = 0;
+
+                //tekst zapisano w strefie lokalnej; w godzinie powtarzanej przy zmianie
+                //na czas zimowy odpowiada mu kilka chwil
+                instants.clear();
+                const QDateTime parsed = QDateTime::fromString(text, Qt::ISODate);
+                if (parsed.isValid()) {
+                    for (qint64 shift : {-3600, 0, 3600}) {
+                        const qint64 instant = parsed.toSecsSinceEpoch() + shift;
+                        if (QDateTime::fromSecsSinceEpoch(instant).toString(Qt::ISODate) == text) {
+                            instants.append(instant);
+                        }
+                    }
+                }
+            }
+
+            //pomiary zapisywano od najnowszego, więc najnowszy wiersz grupy to pierwsze wystąpienie
+            //godziny, a kolejny - drugie; pozostałe to powtórne zapisy tych samych pomiarów
+            if (used >= instants.size()) {
+                ++used;
+                ++dropped;
+                continue;
+            }
+
+            insert.addBindValue(sensorId);
+            insert.addBindValue(instants[used++]);
+            insert.addBindValue(select.value(2));
+            insert.addBindValue(select.value(3));
+            insert.addBindValue(select.value(4));
+            if (!insert.exec()) {
+                throw std::runtime_error(
+                    QString("Nie udało się przenieść pomiaru (Sensor ID: %1, Time: %2): %3")
+                        .arg(sensorId)
+                        .arg(text)
+                        .arg(insert.lastError().text())
+                        .toStdString());
+            }
+        }
+        select.finish();
+
+        run("DROP TABLE measurements");
+        run("ALTER TABLE measurements_utc RENAME TO measurements");
+
+        if (dropped > 0) {
+            qDebug() << "Pominięto powtórzone zapisy pomiarów:" << dropped;
+        }
+    });
+}
+
 void DatabaseManager::saveStation(const Station &station) {
     QSqlQuery query;
     query.prepare("INSERT OR REPLACE INTO stations VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
@@ -116,45 +300,46 @@ void DatabaseManager::saveMeasurement(const Measurement &measurement, int sensor
     try {
         //przygotowujemy zapytanie jeden raz
         QSqlQuery query;
-        query.prepare("INSERT OR REPLACE INTO measurements VALUES (?, ?, ?, ?)");
+        query.prepare(MeasurementUpsertSql);
 
-        //otrzymujemy dane do wstawienia
-        const auto& dataPoints = measurement.data();
+        //wiążemy wartości prosto z kolumn - bez QDateTime dla każdego punktu
+        const QVector<qint64> &times = measurement.times();
 
         //rezerwujemy pamięć, aby przyspieszyć wstawianie
         query.setForwardOnly(true);
 
-        int batchSize = 0;
-        const int maxBatchSize = 100; //optymalny rozmiar pakietu
+        //jedna transakcja na cały zapis - dane pochodne powstają w tej samej transakcji,
+        //więc po błędzie nie zostają zatwierdzone pomiary bez ich agregatów
+        QSet<SensorDay> changedDays;
+
+        for (int i = 0; i < times.size(); ++i) {
+            //punkt bez czasu nie ma klucza
+            const qint64 timestamp = times[i];
+            if (timestamp == Measurement::InvalidTime) continue;
 
-        for (const auto &point : dataPoints) {
             //wiążemy parametry
             query.addBindValue(sensorId);
-            query.addBindValue(point.timestamp.toString(Qt::ISODate));
-            query.addBindValue(point.value);
-            query.addBindValue(point.isValid ? 1 : 0);
+            query.addBindValue(timestamp);
+            query.addBindValue(measurement.valueAt(i));
+            query.addBindValue(measurement.isValidAt(i) ? 1 : 0);
+            query.addBindValue(int(measurement.flagsAt(i)));
 
             if (!query.exec()) {
                 throw std::runtime_error(
                     QString("Nie udało się wstawić pomiaru: %1 (Sensor ID: %2, Time: %3)")
                         .arg(query.lastError().text())
                         .arg(sensorId)
-                        .arg(point.timestamp.toString())
+                        .arg(timestamp)
                         .toStdString());
             }
-
-            if (++batchSize >= maxBatchSize) {
-                m_db.commit();
-                if (!m_db.transaction()) {
-                    throw std::runtime_error(
-                        QString("Nie udało się rozpocząć nowej transakcji: %1")
-                            .arg(m_db.lastError().text())
-                            .toStdString());
-                }
-                batchSize = 0;
+            //upsert nie zmienia wiersza, gdy wartość jest taka sama
+            if (query.numRowsAffected() > 0) {
+                changedDays.insert({sensorId, dayOf(timestamp)});
             }
         }
 
+        updateDerivedData(changedDays);
+
         //finalizujemy transakcję
         if (!m_db.commit()) {
             throw std::runtime_error(
@@ -173,6 +358,193 @@ void DatabaseManager::saveMeasurement(const Measurement &measurement, int sensor
     }
 }
 
+void DatabaseManager::saveAirQualityIndex(const AirQualityIndex &index) {
+    saveAirQualityIndices({index});
+}
+
+bool DatabaseManager::runInTransaction(const std::function<void()> &work) {
+    if (!m_db.isOpen()) {
+        qWarning() << "Baza danych nie jest otwarta!";
+        return false;
+    }
+
+    if (!m_db.transaction()) {
+        qWarning() << "Nie udało się rozpocząć transakcji:" << m_db.lastError().text();
+        return false;
+    }
+
+    try {
+        work();
+
+        if (!m_db.commit()) {
+            throw std::runtime_error(
+                QString("Nie udało się zatwierdzić transakcji: %1")
+                    .arg(m_db.lastError().text())
+                    .toStdString());
+        }
+    } catch (const std::exception &e) {
+        m_db.rollback();
+        qCritical() << "Zapis pakietu nie powiódł się:" << e.what();
+        return false;
+    }
+
+    return true;
+}
+
+//zapisy pakietowe - jedna transakcja i jedno przygotowane zapytanie na pakiet
+bool DatabaseManager::saveStations(const QVector<Station> &stations) {
+    return runInTransaction([&]() {
+        QSqlQuery query;
+        query.prepare("INSERT OR REPLACE INTO stations VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+        for (const auto &station : stations) {
+            query.addBindValue(station.id());
+            query.addBindValue(station.name());
+            query.addBindValue(station.latitude());
+            query.addBindValue(station.longitude());
+            query.addBindValue(station.address().cityId);
+            query.addBindValue(station.address().cityName);
+            query.addBindValue(station.address().communeName);
+            query.addBindValue(station.address().districtName);
+            query.addBindValue(station.address().provinceName);
+            query.addBindValue(station.address().streetName);
+
+            if (!query.exec()) {
+                throw std::runtime_error(
+                    QString("Nie udało się zapisać stacji %1: %2")
+                        .arg(station.id())
+                        .arg(query.lastError().text())
+                        .toStdString());
+            }
+        }
+    });
+}
+
+bool DatabaseManager::saveSensors(const QVector<Sensor> &sensors) {
+    return runInTransaction([&]() {
+        QSqlQuery query;
+        query.prepare("INSERT OR REPLACE INTO sensors VALUES (?, ?, ?, ?, ?, ?)");
+
+        for (const auto &sensor : sensors) {
+            query.addBindValue(sensor.id());
+            query.addBindValue(sensor.stationId());
+            query.addBindValue(sensor.parameter().name);
+            query.addBindValue(sensor.parameter().formula);
+            query.addBindValue(sensor.parameter().code);
+            query.addBindValue(sensor.parameter().id);
+
+            if (!query.exec()) {
+                throw std::runtime_error(
+                    QString("Nie udało się zapisać czujnika %1: %2")
+                        .arg(sensor.id())
+                        .arg(query.lastError().text())
+                        .toStdString());
+            }
+        }
+    });
+}
+
+bool DatabaseManager::saveMeasurements(const QVector<Measurement> &measurements) {
+    return runInTransaction([&]() {
+        QSqlQuery query;
+        query.prepare(MeasurementUpsertSql);
+        query.setForwardOnly(true);
+        QSet<SensorDay> changedDays;
+
+        for (const auto &measurement : measurements) {
+            const QVector<qint64> &times = measurement.times();
+            for (int i = 0; i < times.size(); ++i) {
+                const qint64 timestamp = times[i];
+                if (timestamp == Measurement::InvalidTime) continue;
+
+                query.addBindValue(measurement.sensorId());
+                query.addBindValue(timestamp);
+                query.addBindValue(measurement.valueAt(i));
+                query.addBindValue(measurement.isValidAt(i) ? 1 : 0);
+                query.addBindValue(int(measurement.flagsAt(i)));
+
+                if (!query.exec()) {
+                    throw std::runtime_error(
+                        QString("Nie udało się wstawić pomiaru: %1 (Sensor ID: %2)")
+                            .arg(query.lastError().text())
+                            .arg(measurement.sensorId())
+                            .toStdString());
+                }
+                if (query.numRowsAffected() > 0) {
+                    changedDays.insert({measurement.sensorId(), dayOf(timestamp)});
+                }
+            }
+        }
+
+        updateDerivedData(changedDays);
+    });
+}
+
+bool DatabaseManager::saveIndexHistories(const QVector<AirQualityCalculator::IndexHistory> &histories) {
+    return runInTransaction([&]() {
+        QSqlQuery remove;
+        remove.prepare("DELETE FROM air_quality_history WHERE station_id = ? AND timestamp >= ? AND timestamp <= ?");
+        QSqlQuery insert;
+        insert.prepare("INSERT INTO air_quality_history VALUES (?, ?, ?)");
+
+        for (const auto &history : histories) {
+            if (history.levels.isEmpty()) continue;
+
+            //przeliczony zakres zastępujemy w całości - godzina mogła stracić indeks
+            remove.addBindValue(history.stationId);
+            remove.addBindValue(history.start);
+            remove.addBindValue(history.start + qint64(history.levels.size() - 1) * 3600);
+            if (!remove.exec()) {
+                throw std::runtime_error(
+                    QString("Nie udało się usunąć historii indeksu stacji %1: %2")
+                        .arg(history.stationId)
+                        .arg(remove.lastError().text())
+                        .toStdString());
+            }
+
+            for (int row = 0; row < history.levels.size(); ++row) {
+                if (history.levels[row] == AirQualityCalculator::NoIndex) continue;
+
+                insert.addBindValue(history.stationId);
+                insert.addBindValue(history.start + qint64(row) * 3600);
+                insert.addBindValue(int(history.levels[row]));
+                if (!insert.exec()) {
+                    throw std::runtime_error(
+                        QString("Nie udało się zapisać historii indeksu stacji %1: %2")
+                            .arg(history.stationId)
+                            .arg(insert.lastError().text())
+                            .toStdString());
+                }
+            }
+        }
+    });
+}
+
+bool DatabaseManager::saveAirQualityIndices(const QVector<AirQualityIndex> &indices) {
+    return runInTransaction([&]() {
+        QSqlQuery query;
+        query.prepare("INSERT OR REPLACE INTO air_quality VALUES (?, ?, ?, ?, ?)");
+
+        for (const auto &index : indices) {
+            if (!index.isValid()) continue;
+
+            query.addBindValue(index.stationId());
+            query.addBindValue(index.calculationDate().toString(Qt::ISODate));
+            query.addBindValue(index.overallIndex().id);
+            query.addBindValue(index.overallIndex().name);
+            query.addBindValue(index.sourceDataDate().toString(Qt::ISODate));
+
+            if (!query.exec()) {
+                throw std::runtime_error(
+                    QString("Nie udało się zapisać indeksu stacji %1: %2")
+                        .arg(index.stationId())
+                        .arg(query.lastError().text())
+                        .toStdString());
+            }
+        }
+    });
+}
+
 QVector<Station> DatabaseManager::loadStations() {
     QVector<Station> stations;
     QSqlQuery query("SELECT * FROM stations");
@@ -200,3 +572,374 @@ QVector<Station> DatabaseManager::loadStations() {
 
     return stations;
 }
+
+QVector<Measurement::DataPoint> DatabaseManager::loadMeasurements(int sensorId, const QDateTime &from, const QDateTime &to) {
+    QVector<Measurement::DataPoint> points;
+
+    QString sql = "SELECT timestamp, value, is_valid, flags FROM measurements WHERE sensor_id = ?";
+    if (from.isValid()) sql += " AND timestamp >= ?";
+    if (to.isValid()) sql += " AND timestamp <= ?";
+    sql += " ORDER BY timestamp DESC"; //kolejność jak w odpowiedzi API (najnowsze pierwsze)
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    query.addBindValue(sensorId);
+    if (from.isValid()) query.addBindValue(from.toSecsSinceEpoch());
+    if (to.isValid()) query.addBindValue(to.toSecsSinceEpoch());
+
+    if (!query.exec()) {
+        qWarning() << "Błąd odczytu pomiarów:" << query.lastError().text();
+        return points;
+    }
+
+    while (query.next()) {
+        Measurement::DataPoint point;
+        point.timestamp = QDateTime::fromSecsSinceEpoch(query.value(0).toLongLong());
+        point.isValid = query.value(2).toInt() != 0;
+        point.value = point.isValid ? query.value(1).toDouble() : NAN;
+        point.flags = quint8(query.value(3).toUInt());
+        points.append(point);
+    }
+
+    return points;
+}
+
+QHash<int, QVector<Measurement>> DatabaseManager::loadStationSeries(const QVector<int> &stationIds,
+                                                                  const QDateTime &from, const QDateTime &to) {
+    QHash<int, QVector<Measurement>> stations;
+
+    QString sql = "SELECT s.station_id, m.sensor_id, s.param_code, m.timestamp, m.value "
+                  "FROM measurements m JOIN sensors s ON s.id = m.sensor_id WHERE m.is_valid = 1";
+    if (!stationIds.isEmpty()) {
+        QStringList placeholders;
+        for (int i = 0; i < stationIds.size(); ++i) placeholders << "?";
+        sql += QString(" AND s.station_id IN (%1)").arg(placeholders.join(','));
+    }
+    if (from.isValid()) sql += " AND m.timestamp >= ?";
+    if (to.isValid()) sql += " AND m.timestamp <= ?";
+    sql += " ORDER BY m.sensor_id, m.timestamp DESC"; //każda seria od najnowszego - bez sortowania
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (int stationId : stationIds) query.addBindValue(stationId);
+    if (from.isValid()) query.addBindValue(from.toSecsSinceEpoch());
+    if (to.isValid()) query.addBindValue(to.toSecsSinceEpoch());
+
+    if (!query.exec()) {
+        qWarning() << "Błąd odczytu pomiarów stacji:" << query.lastError().text();
+        return stations;
+    }
+
+    Measurement *current = nullptr;
+    while (query.next()) {
+        const int sensorId = query.value(1).toInt();
+        if (!current || current->sensorId() != sensorId) {
+            QVector<Measurement> &series = stations[query.value(0).toInt()];
+            series.append(Measurement(query.value(2).toString(), sensorId));
+            current = &series.last();
+        }
+        current->appendPoint(query.value(3).toLongLong(), query.value(4).toDouble(), true);
+    }
+
+    return stations;
+}
+
+QDateTime DatabaseManager::latestMeasurementTime(int sensorId) {
+    QSqlQuery query;
+    query.prepare("SELECT MAX(timestamp) FROM measurements WHERE sensor_id = ? AND is_valid = 1");
+    query.addBindValue(sensorId);
+
+    if (!query.exec() || !query.next() || query.value(0).isNull()) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromSecsSinceEpoch(query.value(0).toLongLong());
+}
+
+void DatabaseManager::updateSketches(const QSet<SensorDay> &days) {
+    if (days.isEmpty()) return;
+
+    //szkic dnia budujemy od nowa z jego pomiarów (najwyżej kilkadziesiąt wierszy),
+    //bo t-digest nie pozwala usunąć nadpisanej wartości
+    QSqlQuery select;
+    select.setForwardOnly(true);
+    select.prepare("SELECT value FROM measurements WHERE sensor_id = ? "
+                   "AND timestamp >= ? AND timestamp < ? AND is_valid = 1");
+
+    QSqlQuery store;
+    store.prepare("INSERT OR REPLACE INTO measurement_sketches VALUES (?, ?, ?)");
+
+    QSqlQuery remove;
+    remove.prepare("DELETE FROM measurement_sketches WHERE sensor_id = ? AND day = ?");
+
+    for (const SensorDay &day : days) {
+        const QDate date = QDate::fromString(day.second, Qt::ISODate);
+        select.addBindValue(day.first);
+        select.addBindValue(dayStart(date));
+        select.addBindValue(dayStart(date.addDays(1)));
+        if (!select.exec()) {
+            throw std::runtime_error(
+                QString("Nie udało się odczytać pomiarów dnia %1 (Sensor ID: %2): %3")
+                    .arg(day.second)
+                    .arg(day.first)
+                    .arg(select.lastError().text())
+                    .toStdString());
+        }
+
+        QuantileSketch sketch;
+        while (select.next()) {
+            if (!select.value(0).isNull()) {
+                sketch.add(select.value(0).toDouble());
+            }
+        }
+
+        QSqlQuery &query = sketch.isEmpty() ? remove : store;
+        query.addBindValue(day.first);
+        query.addBindValue(day.second);
+        if (!sketch.isEmpty()) {
+            query.addBindValue(sketch.serialize());
+        }
+        if (!query.exec()) {
+            throw std::runtime_error(
+                QString("Nie udało się zapisać szkicu dnia %1 (Sensor ID: %2): %3")
+                    .arg(day.second)
+                    .arg(day.first)
+                    .arg(query.lastError().text())
+                    .toStdString());
+        }
+    }
+}
+
+void DatabaseManager::updateTiers(const QSet<SensorDay> &days) {
+    if (days.isEmpty()) return;
+
+    //zapis i usunięcie agregatu przygotowane raz dla wszystkich przedziałów
+    QSqlQuery upsert;
+    upsert.prepare("INSERT OR REPLACE INTO measurement_tiers VALUES (?, ?, ?, ?, ?, ?, ?)");
+
+    QSqlQuery remove;
+    remove.prepare("DELETE FROM measurement_tiers WHERE sensor_id = ? AND tier = ? AND bucket = ?");
+
+    //doba z surowych pomiarów, tydzień i miesiąc z agregatów dobowych (najwyżej 31 wierszy)
+    QSqlQuery fromRaw;
+    fromRaw.setForwardOnly(true);
+    fromRaw.prepare("SELECT MIN(value), MAX(value), SUM(value), COUNT(value) FROM measurements "
+                    "WHERE sensor_id = ? AND timestamp >= ? AND timestamp < ? AND is_valid = 1");
+
+    QSqlQuery fromDays;
+    fromDays.setForwardOnly(true);
+    fromDays.prepare("SELECT MIN(min), MAX(max), SUM(sum), SUM(count) FROM measurement_tiers "
+                     "WHERE sensor_id = ? AND tier = 1 AND bucket >= ? AND bucket < ?");
+
+    QSet<SensorDay> weeks;
+    QSet<SensorDay> months;
+    for (const SensorDay &day : days) {
+        const QDate date = QDate::fromString(day.second, Qt::ISODate);
+        fromRaw.addBindValue(day.first);
+        fromRaw.addBindValue(dayStart(date));
+        fromRaw.addBindValue(dayStart(date.addDays(1)));
+        storeAggregate(fromRaw, upsert, remove, day.first, AggregateTier::Day, day.second);
+
+        weeks.insert({day.first, date.addDays(1 - date.dayOfWeek()).toString(Qt::ISODate)});
+        months.insert({day.first, QDate(date.year(), date.month(), 1).toString(Qt::ISODate)});
+    }
+
+    for (const SensorDay &week : weeks) {
+        fromDays.addBindValue(week.first);
+        fromDays.addBindValue(week.second);
+        fromDays.addBindValue(QDate::fromString(week.second, Qt::ISODate).addDays(7).toString(Qt::ISODate));
+        storeAggregate(fromDays, upsert, remove, week.first, AggregateTier::Week, week.second);
+    }
+
+    for (const SensorDay &month : months) {
+        fromDays.addBindValue(month.first);
+        fromDays.addBindValue(month.second);
+        fromDays.addBindValue(QDate::fromString(month.second, Qt::ISODate).addMonths(1).toString(Qt::ISODate));
+        storeAggregate(fromDays, upsert, remove, month.first, AggregateTier::Month, month.second);
+    }
+}
+
+void DatabaseManager::storeAggregate(QSqlQuery &query, QSqlQuery &upsert, QSqlQuery &remove,
+                                     int sensorId, AggregateTier tier, const QString &bucket) {
+    if (!query.exec() || !query.next()) {
+        throw std::runtime_error(
+            QString("Nie udało się wyznaczyć agregatu %1 (Sensor ID: %2): %3")
+                .arg(bucket)
+                .arg(sensorId)
+                .arg(query.lastError().text())
+                .toStdString());
+    }
+
+    const int count = query.value(3).toInt();
+    QSqlQuery &write = count > 0 ? upsert : remove;
+    write.addBindValue(sensorId);
+    write.addBindValue(int(tier));
+    write.addBindValue(bucket);
+    if (count > 0) {
+        write.addBindValue(query.value(0).toDouble());
+        write.addBindValue(query.value(1).toDouble());
+        write.addBindValue(query.value(2).toDouble());
+        write.addBindValue(count);
+    }
+    query.finish();
+
+    if (!write.exec()) {
+        throw std::runtime_error(
+            QString("Nie udało się zapisać agregatu %1 (Sensor ID: %2): %3")
+                .arg(bucket)
+                .arg(sensorId)
+                .arg(write.lastError().text())
+                .toStdString());
+    }
+}
+
+void DatabaseManager::updateDerivedData(const QSet<SensorDay> &days) {
+    updateSketches(days);
+    updateTiers(days);
+}
+
+void DatabaseManager::ensureDerivedData(int sensorId) {
+    if (!m_pendingDerived.contains(sensorId)) return;
+
+    const bool built = runInTransaction([&]() {
+        //granice dni czasu polskiego leżą na pełnych godzinach UTC
+        QSet<SensorDay> days;
+        QSqlQuery query;
+        query.setForwardOnly(true);
+        query.prepare("SELECT DISTINCT timestamp / 3600 FROM measurements WHERE sensor_id = ?");
+        query.addBindValue(sensorId);
+        if (!query.exec()) {
+            throw std::runtime_error(
+                QString("Nie udało się odczytać dni pomiarowych (Sensor ID: %1): %2")
+                    .arg(sensorId)
+                    .arg(query.lastError().text())
+                    .toStdString());
+        }
+        while (query.next()) {
+            days.insert({sensorId, dayOf(query.value(0).toLongLong() * 3600)});
+        }
+
+        qDebug() << "Budowanie szkiców kwantyli i agregatów czujnika" << sensorId
+                 << "dla" << days.size() << "dni pomiarowych";
+        updateDerivedData(days);
+
+        QSqlQuery done;
+        done.prepare("DELETE FROM derived_pending WHERE sensor_id = ?");
+        done.addBindValue(sensorId);
+        if (!done.exec()) {
+            throw std::runtime_error(
+                QString("Nie udało się oznaczyć danych pochodnych (Sensor ID: %1): %2")
+                    .arg(sensorId)
+                    .arg(done.lastError().text())
+                    .toStdString());
+        }
+    });
+
+    if (built) {
+        m_pendingDerived.remove(sensorId);
+    }
+}
+
+QuantileSketch DatabaseManager::loadSketch(const QVector<int> &sensorIds, const QDate &from, const QDate &to) {
+    QuantileSketch result;
+    if (sensorIds.isEmpty()) return result;
+    for (int sensorId : sensorIds) ensureDerivedData(sensorId);
+
+    QStringList placeholders;
+    for (int i = 0; i < sensorIds.size(); ++i) placeholders << "?";
+
+    QString sql = QString("SELECT digest FROM measurement_sketches WHERE sensor_id IN (%1)")
+                      .arg(placeholders.join(", "));
+    if (from.isValid()) sql += " AND day >= ?";
+    if (to.isValid()) sql += " AND day <= ?";
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (int sensorId : sensorIds) query.addBindValue(sensorId);
+    if (from.isValid()) query.addBindValue(from.toString(Qt::ISODate));
+    if (to.isValid()) query.addBindValue(to.toString(Qt::ISODate));
+
+    if (!query.exec()) {
+        qWarning() << "Błąd odczytu szkiców kwantyli:" << query.lastError().text();
+        return result;
+    }
+
+    while (query.next()) {
+        result.merge(QuantileSketch::deserialize(query.value(0).toByteArray()));
+    }
+    return result;
+}
+
+QVector<MeasurementAggregate> DatabaseManager::loadAggregates(int sensorId, const QDateTime &from, const QDateTime &to,
+                                                              qint64 resolutionSecs, AggregateTier *usedTier) {
+    QVector<MeasurementAggregate> result;
+
+    //najgrubszy poziom, którego przedział nie przekracza żądanej rozdzielczości
+    AggregateTier tier = AggregateTier::Hour;
+    if (resolutionSecs >= 28 * 86400) tier = AggregateTier::Month;
+    else if (resolutionSecs >= 7 * 86400) tier = AggregateTier::Week;
+    else if (resolutionSecs >= 86400) tier = AggregateTier::Day;
+    if (usedTier) *usedTier = tier;
+
+    QSqlQuery query;
+    query.setForwardOnly(true);
+
+    if (tier == AggregateTier::Hour) {
+        QString sql = "SELECT timestamp, value FROM measurements WHERE sensor_id = ? AND is_valid = 1";
+        if (from.isValid()) sql += " AND timestamp >= ?";
+        if (to.isValid()) sql += " AND timestamp <= ?";
+        sql += " ORDER BY timestamp";
+        query.prepare(sql);
+        query.addBindValue(sensorId);
+        if (from.isValid()) query.addBindValue(from.toSecsSinceEpoch());
+        if (to.isValid()) query.addBindValue(to.toSecsSinceEpoch());
+
+        if (!query.exec()) {
+            qWarning() << "Błąd odczytu pomiarów:" << query.lastError().text();
+            return result;
+        }
+        while (query.next()) {
+            const double value = query.value(1).toDouble();
+            result.append({QDateTime::fromSecsSinceEpoch(query.value(0).toLongLong()), value, value, value, 1});
+        }
+        return result;
+    }
+
+    ensureDerivedData(sensorId);
+
+    //przedział zawierający początek zakresu też się liczy
+    QString sql = "SELECT bucket, min, max, sum, count FROM measurement_tiers WHERE sensor_id = ? AND tier = ?";
+    if (from.isValid()) sql += " AND bucket >= ?";
+    if (to.isValid()) sql += " AND bucket <= ?";
+    sql += " ORDER BY bucket";
+    query.prepare(sql);
+    query.addBindValue(sensorId);
+    query.addBindValue(int(tier));
+    //granice zakresu jako dni kalendarza polskiego - tak jak klucze agregatów w updateTiers
+    if (from.isValid()) {
+        QDate start = QDate::fromString(dayOf(from.toSecsSinceEpoch()), Qt::ISODate);
+        if (tier == AggregateTier::Week) start = start.addDays(1 - start.dayOfWeek());
+        if (tier == AggregateTier::Month) start = QDate(start.year(), start.month(), 1);
+        query.addBindValue(start.toString(Qt::ISODate));
+    }
+    if (to.isValid()) query.addBindValue(dayOf(to.toSecsSinceEpoch()));
+
+    if (!query.exec()) {
+        qWarning() << "Błąd odczytu agregatów:" << query.lastError().text();
+        return result;
+    }
+    while (query.next()) {
+        const int count = query.value(4).toInt();
+        //początek przedziału to północ czasu polskiego, niezależnie od strefy systemu
+        const QDate bucket = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+        result.append({QDateTime::fromSecsSinceEpoch(dayStart(bucket)),
+                       query.value(1).toDouble(),
+                       query.value(2).toDouble(),
+                       count > 0 ? query.value(3).toDouble() / count : NAN,
+                       count});
+    }
+    return result;
+}
@@ -13,6 +13,34 @@
 #include "Sensor.h"
 #include "Measurement.h"
 #include "AirQualityIndex.h"
+#include "AirQualityCalculator.h"
+#include "QuantileSketch.h"
+#include <QSet>
+#include <QPair>
+#include <functional>
+
+/**
+ * @enum AggregateTier
+ * @brief Poziom agregacji pomiarów w bazie danych
+ */
+enum class AggregateTier {
+    Hour = 0,   /**< Surowe pomiary godzinowe */
+    Day = 1,    /**< Agregaty dobowe */
+    Week = 2,   /**< Agregaty tygodniowe (od poniedziałku) */
+    Month = 3   /**< Agregaty miesięczne */
+};
+
+/**
+ * @struct MeasurementAggregate
+ * @brief Agregat pomiarów czujnika w jednym przedziale czasu
+ */
+struct MeasurementAggregate {
+    QDateTime start;    /**< Początek przedziału */
+    double min;         /**< Minimalna wartość */
+    double max;         /**< Maksymalna wartość */
+    double mean;        /**< Średnia wartość */
+    int count;          /**< Liczba poprawnych pomiarów */
+};
 
 /**
  * @class DatabaseManager
@@ -73,6 +101,42 @@ public:
      */
     void saveAirQualityIndex(const AirQualityIndex &index);
 
+    /**
+     * @brief Zapisuje pakiet stacji w jednej transakcji
+     * @param stations Wektor stacji do zapisania
+     * @return true jeśli zapis się powiódł, false w przeciwnym przypadku
+     */
+    bool saveStations(const QVector<Station> &stations);
+
+    /**
+     * @brief Zapisuje pakiet czujników w jednej transakcji
+     * @param sensors Wektor czujników do zapisania
+     * @return true jeśli zapis się powiódł, false w przeciwnym przypadku
+     */
+    bool saveSensors(const QVector<Sensor> &sensors);
+
+    /**
+     * @brief Zapisuje pakiet serii pomiarowych w jednej transakcji
+     * @param measurements Wektor serii pomiarów (ID czujnika brane z Measurement::sensorId())
+     * @return true jeśli zapis się powiódł, false w przeciwnym przypadku
+     */
+    bool saveMeasurements(const QVector<Measurement> &measurements);
+
+    /**
+     * @brief Zapisuje pakiet wskaźników jakości powietrza w jednej transakcji
+     * @param indices Wektor wskaźników do zapisania
+     * @return true jeśli zapis się powiódł, false w przeciwnym przypadku
+     */
+    bool saveAirQualityIndices(const QVector<AirQualityIndex> &indices);
+
+    /**
+     * @brief Zapisuje godzinowe historie indeksu jakości powietrza w jednej transakcji
+     * @param histories Historie stacji wyznaczone przez AirQualityCalculator::histories()
+     * @return true jeśli zapis się powiódł, false w przeciwnym przypadku
+     * @note Zakres godzin każdej historii jest zastępowany w całości - godziny bez indeksu nie mają wiersza
+     */
+    bool saveIndexHistories(const QVector<AirQualityCalculator::IndexHistory> &histories);
+
     /**
      * @brief Wczytuje listę stacji z bazy danych
      * @return Wektor zawierający wczytane stacje
@@ -95,6 +159,44 @@ public:
      */
     QVector<Measurement::DataPoint> loadMeasurements(int sensorId, const QDateTime &from, const QDateTime &to);
 
+    /**
+     * @brief Zwraca czas najnowszego poprawnego pomiaru czujnika (high-water mark)
+     * @param sensorId ID czujnika
+     * @return Czas najnowszego poprawnego pomiaru lub niepoprawny QDateTime gdy brak danych
+     */
+    QDateTime latestMeasurementTime(int sensorId);
+
+    /**
+     * @brief Wczytuje poprawne pomiary wszystkich czujników stacji jednym zapytaniem
+     * @param stationIds ID stacji (pusty wektor - wszystkie stacje)
+     * @param from Data początkowa zakresu
+     * @param to Data końcowa zakresu
+     * @return Serie czujników (z kodem parametru i ID czujnika) według ID stacji
+     */
+    QHash<int, QVector<Measurement>> loadStationSeries(const QVector<int> &stationIds,
+                                                      const QDateTime &from, const QDateTime &to);
+
+    /**
+     * @brief Zwraca szkic kwantyli pomiarów scalony z dziennych szkiców
+     * @param sensorIds ID czujników (np. wszystkich czujników PM10 w regionie)
+     * @param from Pierwszy dzień zakresu (niepoprawna data - bez dolnej granicy)
+     * @param to Ostatni dzień zakresu (niepoprawna data - bez górnej granicy)
+     * @return Szkic pozwalający wyznaczyć percentyle bez odczytu surowych pomiarów
+     */
+    QuantileSketch loadSketch(const QVector<int> &sensorIds, const QDate &from, const QDate &to);
+
+    /**
+     * @brief Wczytuje pomiary czujnika w rozdzielczości dobranej do zakresu
+     * @param sensorId ID czujnika
+     * @param from Data początkowa zakresu
+     * @param to Data końcowa zakresu
+     * @param resolutionSecs Żądana rozdzielczość (odstęp między punktami) w sekundach
+     * @param usedTier Wybrany poziom agregacji (opcjonalnie)
+     * @return Agregaty od najstarszego, z najgrubszego poziomu nie grubszego niż resolutionSecs
+     */
+    QVector<MeasurementAggregate> loadAggregates(int sensorId, const QDateTime &from, const QDateTime &to,
+                                                 qint64 resolutionSecs, AggregateTier *usedTier = nullptr);
+
     /**
      * @brief Wczytuje wskaźnik jakości powietrza dla określonej stacji
      * @param stationId ID stacji
@@ -103,11 +205,75 @@ public:
     AirQualityIndex loadAirQualityIndex(int stationId);
 
 private:
+    /// Dzień pomiarów czujnika (ID czujnika, data "yyyy-MM-dd")
+    using SensorDay = QPair<int, QString>;
+
     QSqlDatabase m_db; /**< Obiekt bazy danych SQLite */
+    QSet<int> m_pendingDerived; /**< Czujniki bez zbudowanych danych pochodnych (kopia tabeli derived_pending) */
 
     /**
      * @brief Tworzy tabele w bazie danych jeśli nie istnieją
      * @return true jeśli operacja się powiodła, false w przeciwnym przypadku
      */
     bool createTables();
+
+    /**
+     * @brief Przenosi tabelę pomiarów z tekstowych czasów lokalnych na sekundy UTC
+     *
+     * Czas zapisany w ISO bez strefy powtarza się przy zmianie czasu na zimowy, przez co
+     * klucz (czujnik, czas) sklejałby dwa różne pomiary. Wiersze o tym samym zapisie
+     * dostają kolejne chwile odpowiadające temu zapisowi; nadmiarowe (powtórne zapisy
+     * z czasów bez klucza unikalnego) są pomijane.
+     * @return true jeśli migracja się powiodła, false w przeciwnym przypadku
+     */
+    bool migrateMeasurementTimes();
+
+    /**
+     * @brief Wykonuje operację w obrębie jednej transakcji
+     * @param work Operacja zapisu rzucająca std::runtime_error w razie błędu
+     * @return true jeśli transakcja została zatwierdzona, false jeśli wycofana
+     */
+    bool runInTransaction(const std::function<void()> &work);
+
+    /**
+     * @brief Przelicza dzienne szkice kwantyli dla dni, w których zmieniły się pomiary
+     * @param days Zmienione dni czujników
+     * @throws std::runtime_error Gdy zapis szkicu się nie powiedzie
+     */
+    void updateSketches(const QSet<SensorDay> &days);
+
+    /**
+     * @brief Przelicza agregaty dobowe, tygodniowe i miesięczne dla zmienionych dni
+     * @param days Zmienione dni czujników
+     * @throws std::runtime_error Gdy zapis agregatu się nie powiedzie
+     */
+    void updateTiers(const QSet<SensorDay> &days);
+
+    /**
+     * @brief Zapisuje agregat jednego przedziału (lub usuwa go, gdy brak pomiarów)
+     * @param query Wynik zapytania z kolumnami MIN, MAX, SUM, COUNT
+     * @param upsert Przygotowane zapytanie zapisu agregatu
+     * @param remove Przygotowane zapytanie usunięcia agregatu
+     * @param sensorId ID czujnika
+     * @param tier Poziom agregacji
+     * @param bucket Początek przedziału ("yyyy-MM-dd")
+     * @throws std::runtime_error Gdy zapis się nie powiedzie
+     */
+    void storeAggregate(QSqlQuery &query, QSqlQuery &upsert, QSqlQuery &remove,
+                        int sensorId, AggregateTier tier, const QString &bucket);
+
+    /**
+     * @brief Przelicza dane pochodne (szkice kwantyli i agregaty) dla zmienionych dni
+     * @param days Zmienione dni czujników
+     */
+    void updateDerivedData(const QSet<SensorDay> &days);
+
+    /**
+     * @brief Buduje dane pochodne czujnika, jeśli czeka w kolejce derived_pending
+     *
+     * Wywoływane przed odczytem szkiców i agregatów, dzięki czemu uzupełnianie danych
+     * pochodnych po migracji nie blokuje startu programu.
+     * @param sensorId ID czujnika
+     */
+    void ensureDerivedData(int sensorId);
 };
@@ -0,0 +1,373 @@
+#include "MeasurementDecoder.h"
+#include "TimestampParser.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+//dopisuje kod Unicode w UTF-8
+void appendUtf8(QByteArray &out, uint codePoint) {
+    if (codePoint < 0x80) {
+        out.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        out.append(char(0xC0 | (codePoint >> 6)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.append(char(0xE0 | (codePoint >> 12)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (codePoint >> 18)));
+        out.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+//parsuje 4 cyfry szesnastkowe, zwraca -1 przy błędzie
+int parseHex4(const char *d) {
+    int value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = d[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return -1;
+    }
+    return value;
+}
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+}
+
+MeasurementDecoder::MeasurementDecoder(int sensorId)
+    : m_sensorId(sensorId)
+{
+}
+
+bool MeasurementDecoder::feed(const QByteArray &chunk) {
+    if (hasError()) return false;
+
+    //usuwamy już zdekodowaną część, zostaje tylko niepełny token
+    if (m_pos > 0) {
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+    }
+    m_buffer.append(chunk);
+
+    return parseAvailable();
+}
+
+bool MeasurementDecoder::finish() {
+    if (hasError()) return false;
+
+    m_finished = true;
+    if (!parseAvailable()) return false;
+
+    if (!m_done) {
+        setError(m_stack.isEmpty() && m_pos >= m_buffer.size()
+                     ? "Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON"
+                     : "Niekompletny dokument JSON");
+        return false;
+    }
+    return true;
+}
+
+Measurement MeasurementDecoder::takeMeasurement() {
+    //kod parametru jak w Measurement(const QJsonObject&): paramCode, potem prefiks key
+    if (!m_paramCode.isEmpty()) {
+        m_measurement.setParamCode(m_paramCode);
+    } else if (!m_key.isEmpty()) {
+        m_measurement.setParamCode(m_key.split('_').first());
+    } else {
+        m_measurement.setParamCode("Nieznany");
+    }
+    m_measurement.setSensorId(m_sensorId);
+    m_measurement.sortByTime();
+
+    Measurement result = std::move(m_measurement);
+    m_measurement = Measurement();
+    return result;
+}
+
+bool MeasurementDecoder::decode(const QByteArray &body, int sensorId, Measurement &measurement, QString *error) {
+    MeasurementDecoder decoder(sensorId);
+
+    if (!decoder.feed(body) || !decoder.finish()) {
+        if (error) *error = decoder.errorString();
+        return false;
+    }
+
+    measurement = decoder.takeMeasurement();
+    return true;
+}
+
+bool MeasurementDecoder::parseAvailable() {
+    const char *d = m_buffer.constData();
+    const qsizetype n = m_buffer.size();
+
+    while (m_pos < n && !hasError()) {
+        const char c = d[m_pos];
+
+        switch (c) {
+        case ' ': case '\t': case '\n': case '\r': case ':':
+            ++m_pos;
+            break;
+
+        case ',':
+            if (!m_stack.isEmpty() && m_stack.last() == Container::Object) {
+                m_expectKey = true;
+            }
+            ++m_pos;
+            break;
+
+        case '{':
+            startContainer(Container::Object);
+            ++m_pos;
+            break;
+
+        case '[':
+            startContainer(Container::Array);
+            ++m_pos;
+            break;
+
+        case '}':
+        case ']':
+            if (!endContainer(c == '}' ? Container::Object : Container::Array)) return false;
+            ++m_pos;
+            break;
+
+        case '"': {
+            qsizetype pos = m_pos;
+            const int result = readString(pos, m_token);
+            if (result == 0) return true; //czekamy na resztę stringu
+            if (result < 0) {
+                setError("Nieprawidłowy string JSON");
+                return false;
+            }
+            m_pos = pos;
+
+            if (m_expectKey) {
+                m_keys.last() = m_token;
+                m_expectKey = false;
+            } else {
+                onString(m_token);
+            }
+            break;
+        }
+
+        case 't': case 'f': case 'n': {
+            const char *literal = c == 't' ? "true" : (c == 'f' ? "false" : "null");
+            const qsizetype length = qsizetype(std::strlen(literal));
+            const qsizetype available = qMin(length, n - m_pos);
+
+            if (std::memcmp(d + m_pos, literal, size_t(available)) != 0) {
+                setError("Nieprawidłowy literał JSON");
+                return false;
+            }
+            if (available < length) {
+                if (m_finished) setError("Niekompletny literał JSON");
+                return !hasError();
+            }
+
+            m_pos += length;
+            if (c == 'n') onNull();
+            break;
+        }
+
+        default: {
+            if (!isNumberChar(c)) {
+                setError(QString("Nieoczekiwany znak w JSON na pozycji %1").arg(m_pos));
+                return false;
+            }
+
+            qsizetype end = m_pos;
+            while (end < n && isNumberChar(d[end])) ++end;
+            if (end == n && !m_finished) return true; //liczba może być kontynuowana
+
+            bool ok = false;
+            const double value = QByteArray::fromRawData(d + m_pos, end - m_pos).toDouble(&ok);
+            if (!ok) {
+                setError("Nieprawidłowa liczba JSON");
+                return false;
+            }
+            m_pos = end;
+            onNumber(value);
+            break;
+        }
+        }
+    }
+
+    return !hasError();
+}
+
+int MeasurementDecoder::readString(qsizetype &pos, QByteArray &out) {
+    const char *d = m_buffer.constData();
+    const qsizetype n = m_buffer.size();
+    qsizetype i = pos + 1;
+    out.resize(0);
+
+    while (i < n) {
+        //kopiujemy ciągi zwykłych znaków w jednym kroku
+        qsizetype run = i;
+        while (run < n && d[run] != '"' && d[run] != '\\') ++run;
+        out.append(d + i, run - i);
+        i = run;
+        if (i >= n) break;
+
+        if (d[i] == '"') {
+            pos = i + 1;
+            return 1;
+        }
+
+        //sekwencja ucieczki
+        if (i + 1 >= n) return 0;
+        switch (d[i + 1]) {
+        case '"': out.append('"'); break;
+        case '\\': out.append('\\'); break;
+        case '/': out.append('/'); break;
+        case 'b': out.append('\b'); break;
+        case 'f': out.append('\f'); break;
+        case 'n': out.append('\n'); break;
+        case 'r': out.append('\r'); break;
+        case 't': out.append('\t'); break;
+        case 'u': {
+            if (i + 6 > n) return 0;
+            int codePoint = parseHex4(d + i + 2);
+            if (codePoint < 0) return -1;
+
+            //para surogatów
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                if (i + 12 > n) return 0;
+                if (d[i + 6] != '\\' || d[i + 7] != 'u') return -1;
+                const int low = parseHex4(d + i + 8);
+                if (low < 0xDC00 || low > 0xDFFF) return -1;
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            }
+            appendUtf8(out, uint(codePoint));
+            i += 4;
+            break;
+        }
+        default:
+            return -1;
+        }
+        i += 2;
+    }
+
+    return 0;
+}
+
+void MeasurementDecoder::startContainer(Container type) {
+    if (m_done) {
+        setError("Dodatkowe dane po obiekcie JSON");
+        return;
+    }
+    if (m_stack.isEmpty() && type != Container::Object) {
+        setError("Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON");
+        return;
+    }
+
+    const int depth = m_stack.size();
+
+    //tablica "values" obiektu głównego
+    if (type == Container::Array && depth == 1 && m_keys.last() == "values") {
+        m_inValues = true;
+    }
+
+    //obiekt punktu pomiarowego w tablicy "values"
+    if (type == Container::Object && depth == 2 && m_inValues) {
+        m_inPoint = true;
+        m_point = PendingPoint();
+    }
+
+    m_stack.append(type);
+    m_keys.append(QByteArray());
+    m_expectKey = type == Container::Object;
+}
+
+bool MeasurementDecoder::endContainer(Container type) {
+    if (m_stack.isEmpty() || m_stack.last() != type) {
+        setError("Niezgodne nawiasy w JSON");
+        return false;
+    }
+
+    const int depth = m_stack.size();
+    if (m_inPoint && depth == 3) {
+        m_inPoint = false;
+        m_measurement.appendPoint(m_point.time, m_point.value, m_point.isValid);
+    }
+    if (m_inValues && depth == 2) {
+        m_inValues = false;
+    }
+
+    m_stack.removeLast();
+    m_keys.removeLast();
+    m_expectKey = false;
+
+    if (m_stack.isEmpty()) {
+        m_done = true;
+    }
+    return true;
+}
+
+void MeasurementDecoder::onString(const QByteArray &value) {
+    const int depth = m_stack.size();
+    if (depth == 0) {
+        setError("Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON");
+        return;
+    }
+
+    const QByteArray &key = m_keys.last();
+
+    if (depth == 1) {
+        if (key == "key") m_key = QString::fromUtf8(value);
+        else if (key == "paramCode") m_paramCode = QString::fromUtf8(value);
+        return;
+    }
+
+    if (m_inPoint && depth == 3) {
+        if (key == "date") {
+            m_point.time = TimestampParser::parse(value.constData(), value.size());
+        } else if (key == "value") {
+            bool ok = false;
+            const double parsed = value.toDouble(&ok);
+            m_point.value = ok ? parsed : NAN;
+            m_point.isValid = ok;
+        }
+    }
+}
+
+void MeasurementDecoder::onNumber(double value) {
+    const int depth = m_stack.size();
+    if (depth == 0) {
+        setError("Nieprawidłowy format odpowiedzi: oczekiwany obiekt JSON");
+        return;
+    }
+
+    const QByteArray &key = m_keys.last();
+
+    if (depth == 1 && key == "sensorId") {
+        m_sensorId = int(value);
+    } else if (m_inPoint && depth == 3 && key == "value") {
+        m_point.value = value;
+        m_point.isValid = true;
+    }
+}
+
+void MeasurementDecoder::onNull() {
+    if (m_inPoint && m_stack.size() == 3 && m_keys.last() == "value") {
+        m_point.value = NAN;
+        m_point.isValid = false;
+    }
+}
+
+void MeasurementDecoder::setError(const QString &message) {
+    if (m_error.isEmpty()) {
+        m_error = message;
+    }
+}
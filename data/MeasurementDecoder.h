@@ -0,0 +1,126 @@
+/**
+ * @file measurementdecoder.h
+ * @brief Plik nagłówkowy zawierający definicję klasy MeasurementDecoder
+ *
+ * Strumieniowy (SAX) dekoder odpowiedzi data/getData API GIOS
+ */
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <cmath>
+#include "Measurement.h"
+
+/**
+ * @class MeasurementDecoder
+ * @brief Przyrostowy dekoder pomiarów bez budowania drzewa QJsonDocument
+ *
+ * Dekoder przyjmuje kolejne fragmenty odpowiedzi (w dowolnych miejscach podziału)
+ * i zapisuje punkty z tablicy "values" bezpośrednio do obiektu Measurement.
+ * Nieznane pola są pomijane bez alokacji. Bufor wewnętrzny przechowuje jedynie
+ * niedokończony token z końca ostatniego fragmentu. NetworkWorker zasila dekoder
+ * bezpośrednio z bufora odpowiedzi sieciowej przy każdym sygnale readyRead.
+ */
+class MeasurementDecoder {
+public:
+    /**
+     * @brief Konstruktor klasy MeasurementDecoder
+     * @param sensorId ID czujnika przypisywane do serii (nadpisywane przez pole "sensorId" z JSON)
+     */
+    explicit MeasurementDecoder(int sensorId = 0);
+
+    /**
+     * @brief Przetwarza kolejny fragment odpowiedzi
+     * @param chunk Fragment danych
+     * @return false jeśli wystąpił błąd składni
+     */
+    bool feed(const QByteArray &chunk);
+
+    /**
+     * @brief Kończy dekodowanie po otrzymaniu ostatniego fragmentu
+     * @return true jeśli odczytano kompletny obiekt JSON
+     */
+    bool finish();
+
+    /**
+     * @brief Sprawdza, czy wystąpił błąd dekodowania
+     * @return true jeśli wystąpił błąd
+     */
+    bool hasError() const { return !m_error.isEmpty(); }
+
+    /**
+     * @brief Zwraca opis błędu dekodowania
+     * @return Komunikat błędu
+     */
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Przekazuje zdekodowaną serię pomiarów
+     * @return Obiekt Measurement (dekoder pozostaje pusty)
+     */
+    Measurement takeMeasurement();
+
+    /**
+     * @brief Dekoduje kompletną odpowiedź w jednym wywołaniu
+     * @param body Treść odpowiedzi
+     * @param sensorId ID czujnika
+     * @param measurement Obiekt docelowy
+     * @param error Opcjonalny wskaźnik na komunikat błędu
+     * @return true jeśli dekodowanie się powiodło
+     */
+    static bool decode(const QByteArray &body, int sensorId, Measurement &measurement, QString *error = nullptr);
+
+private:
+    enum class Container : quint8 { Object, Array };
+
+    QByteArray m_buffer;                /**< Niezdekodowane dane (ostatni niepełny token) */
+    qsizetype m_pos = 0;                /**< Pozycja odczytu w buforze */
+    bool m_finished = false;            /**< Czy otrzymano ostatni fragment */
+    bool m_done = false;                /**< Czy zamknięto obiekt główny */
+    QString m_error;                    /**< Komunikat błędu */
+
+    QVector<Container> m_stack;         /**< Stos otwartych kontenerów */
+    QVector<QByteArray> m_keys;         /**< Ostatni klucz na każdym poziomie */
+    bool m_expectKey = false;           /**< Czy następny string jest kluczem obiektu */
+    QByteArray m_token;                 /**< Bufor roboczy dla stringów */
+
+    bool m_inValues = false;            /**< Czy jesteśmy w tablicy "values" */
+    bool m_inPoint = false;             /**< Czy jesteśmy w obiekcie punktu pomiarowego */
+    /**
+     * @struct PendingPoint
+     * @brief Dekodowany punkt w postaci kolumnowej (czas jako sekundy UTC)
+     */
+    struct PendingPoint {
+        qint64 time = Measurement::InvalidTime;   /**< Czas pomiaru (sekundy od epoki) */
+        double value = NAN;                       /**< Wartość pomiaru */
+        bool isValid = false;                     /**< Czy wartość jest poprawna */
+    };
+    PendingPoint m_point;               /**< Aktualnie dekodowany punkt */
+
+    Measurement m_measurement;          /**< Seria wynikowa */
+    QString m_key;                      /**< Pole "key" z odpowiedzi */
+    QString m_paramCode;                /**< Pole "paramCode" z odpowiedzi */
+    int m_sensorId;                     /**< ID czujnika */
+
+    /**
+     * @brief Dekoduje wszystkie kompletne tokeny z bufora
+     * @return false jeśli wystąpił błąd składni
+     */
+    bool parseAvailable();
+
+    /**
+     * @brief Odczytuje string JSON rozpoczynający się na pozycji pos
+     * @param pos Pozycja znaku cudzysłowu; po sukcesie pozycja za stringiem
+     * @param out Zdekodowana zawartość (UTF-8)
+     * @return 1 - kompletny, 0 - potrzeba więcej danych, -1 - błąd
+     */
+    int readString(qsizetype &pos, QByteArray &out);
+
+    void startContainer(Container type);        /**< Obsługa '{' lub '[' */
+    bool endContainer(Container type);          /**< Obsługa '}' lub ']' */
+    void onString(const QByteArray &value);     /**< Obsługa wartości tekstowej */
+    void onNumber(double value);                /**< Obsługa wartości liczbowej */
+    void onNull();                              /**< Obsługa wartości null */
+    void setError(const QString &message);      /**< Zapamiętuje pierwszy błąd */
+};
@@ -0,0 +1,81 @@
+#include "NetworkWorker.h"
+#include <QElapsedTimer>
+#include <QNetworkDiskCache>
+#include <QStandardPaths>
+#include <QDebug>
+
+NetworkWorker::NetworkWorker(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<NetworkResponse>("NetworkResponse");
+}
+
+QNetworkAccessManager *NetworkWorker::manager() {
+    //menedżer tworzymy dopiero w wątku sieciowym
+    if (!m_manager) {
+        //limit czasu ustawia ApiHandler dla każdego żądania osobno
+        m_manager = new QNetworkAccessManager(this);
+
+        //dyskowa pamięć podręczna - żądania warunkowe (If-None-Match/If-Modified-Since) wysyła Qt
+        auto *cache = new QNetworkDiskCache(m_manager);
+        cache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http");
+        cache->setMaximumCacheSize(CacheSizeBytes);
+        m_manager->setCache(cache);
+    }
+    return m_manager;
+}
+
+void NetworkWorker::get(quint64 requestId, const QNetworkRequest &request,
+                        const std::shared_ptr<MeasurementDecoder> &decoder) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QNetworkReply *reply = manager()->get(request);
+    m_replies.insert(requestId, reply);
+
+    if (decoder) {
+        //dekodowanie w miarę nadchodzenia danych - pełna treść nie jest buforowana
+        connect(reply, &QNetworkReply::readyRead, this, [reply, decoder]() {
+            decoder->feed(reply->readAll());
+        });
+    }
+
+    //świeży wpis z pamięci podręcznej kończy się bez wysłania żądania, 304 wymaga wymiany z serwerem
+    connect(reply, &QNetworkReply::requestSent, reply, [reply]() {
+        reply->setProperty("requestSent", true);
+    });
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, requestId, timer, decoder]() {
+        m_replies.remove(requestId);
+
+        NetworkResponse response;
+        response.requestId = requestId;
+        response.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        response.error = reply->error();
+        response.errorString = reply->errorString();
+        if (decoder) {
+            decoder->feed(reply->readAll());
+            if (reply->error() == QNetworkReply::NoError) {
+                decoder->finish();
+            }
+            response.decoder = decoder;
+        } else {
+            response.body = reply->readAll();
+        }
+        response.fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+        response.revalidated = response.fromCache && reply->property("requestSent").toBool();
+        response.validator = reply->hasRawHeader("ETag") ? reply->rawHeader("ETag")
+                                                         : reply->rawHeader("Last-Modified");
+        response.elapsedMs = timer.elapsed();
+
+        reply->deleteLater();
+        emit finished(response);
+    });
+}
+
+void NetworkWorker::abort(quint64 requestId) {
+    //żądanie mogło się już zakończyć - wtedy odpowiedź jest w drodze do ApiHandler
+    QNetworkReply *reply = m_replies.value(requestId);
+    if (reply) {
+        reply->abort();
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * @file networkworker.h
+ * @brief Plik nagłówkowy zawierający definicję klasy NetworkWorker
+ *
+ * Klasa wykonująca żądania HTTP w dedykowanym wątku sieciowym
+ */
+
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <memory>
+#include "MeasurementDecoder.h"
+
+/**
+ * @struct NetworkResponse
+ * @brief Wynik pojedynczego żądania HTTP przekazywany między wątkami
+ */
+struct NetworkResponse {
+    quint64 requestId = 0;                                  /**< Identyfikator żądania nadany przez ApiHandler */
+    int httpStatus = 0;                                     /**< Kod statusu HTTP (0 jeśli brak odpowiedzi) */
+    QNetworkReply::NetworkError error = QNetworkReply::NoError; /**< Kod błędu sieci */
+    QString errorString;                                    /**< Opis błędu sieci */
+    QByteArray body;                                        /**< Treść odpowiedzi (pusta przy dekodowaniu strumieniowym) */
+    std::shared_ptr<MeasurementDecoder> decoder;            /**< Dekoder, który otrzymał treść w trakcie pobierania */
+    bool fromCache = false;                                 /**< Czy treść pochodzi z pamięci podręcznej (świeży wpis lub 304) */
+    bool revalidated = false;                               /**< Czy wpis z pamięci podręcznej potwierdził serwer (304) */
+    QByteArray validator;                                   /**< Walidator treści: ETag lub Last-Modified */
+    qint64 elapsedMs = 0;                                   /**< Czas trwania żądania w milisekundach */
+};
+
+Q_DECLARE_METATYPE(NetworkResponse)
+
+/**
+ * @class NetworkWorker
+ * @brief Klasa obsługująca ruch sieciowy w osobnym wątku
+ *
+ * Obiekt jest przenoszony do dedykowanego wątku sieciowego i jako jedyny
+ * korzysta z QNetworkAccessManager. Żądania są nieblokujące, więc w locie
+ * może znajdować się wiele z nich jednocześnie, a wątki puli ApiHandler
+ * zajmują się wyłącznie parsowaniem odpowiedzi.
+ *
+ * Odpowiedzi trafiają do dyskowej pamięci podręcznej HTTP (QNetworkDiskCache) razem
+ * z nagłówkami ETag/Last-Modified/Cache-Control. Przeterminowane wpisy są
+ * rewalidowane żądaniem warunkowym, a odpowiedź 304 zwraca treść z dysku.
+ */
+class NetworkWorker : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy NetworkWorker
+     * @param parent Wskaźnik na obiekt rodzica (domyślnie nullptr)
+     */
+    explicit NetworkWorker(QObject *parent = nullptr);
+
+    /**
+     * @brief Zwraca liczbę żądań znajdujących się aktualnie w locie
+     * @return Liczba aktywnych żądań
+     */
+    int inFlightCount() const { return m_replies.size(); }
+
+public slots:
+    /**
+     * @brief Wysyła żądanie GET
+     * @param requestId Identyfikator żądania
+     * @param request Obiekt żądania sieciowego
+     * @param decoder Dekoder pomiarów zasilany fragmentami odpowiedzi w miarę ich nadchodzenia
+     *                (nullptr - treść buforowana w całości w NetworkResponse::body)
+     */
+    void get(quint64 requestId, const QNetworkRequest &request,
+             const std::shared_ptr<MeasurementDecoder> &decoder = nullptr);
+
+    /**
+     * @brief Przerywa żądanie w locie (odpowiedź kończy się błędem OperationCanceledError)
+     * @param requestId Identyfikator żądania
+     */
+    void abort(quint64 requestId);
+
+signals:
+    /**
+     * @brief Sygnał emitowany po zakończeniu żądania (również z błędem)
+     * @param response Wynik żądania
+     */
+    void finished(const NetworkResponse &response);
+
+private:
+    static constexpr qint64 CacheSizeBytes = 64 * 1024 * 1024; /**< Limit rozmiaru pamięci podręcznej HTTP */
+
+    QNetworkAccessManager *m_manager = nullptr;      /**< Menedżer połączeń tworzony w wątku sieciowym */
+    QHash<quint64, QNetworkReply*> m_replies;        /**< Aktywne odpowiedzi według identyfikatora żądania */
+
+    /**
+     * @brief Zwraca menedżer połączeń, tworząc go przy pierwszym użyciu
+     * @return Wskaźnik na QNetworkAccessManager
+     */
+    QNetworkAccessManager *manager();
+};
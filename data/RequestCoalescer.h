@@ -0,0 +1,109 @@
+/**
+ * @file requestcoalescer.h
+ * @brief Plik nagłówkowy zawierający definicję szablonu RequestCoalescer
+ *
+ * Szablon łączący równoczesne żądania o ten sam zasób w jedno żądanie sieciowe
+ */
+
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "RequestHandle.h"
+
+/**
+ * @class RequestCoalescer
+ * @brief Rejestr żądań w locie kluczowanych znormalizowanym URL
+ *
+ * Pierwszy wywołujący dla danego klucza staje się "liderem" i wykonuje żądanie,
+ * kolejni tylko dopisują swoje callbacki. Po zakończeniu wszyscy otrzymują ten sam,
+ * jednokrotnie sparsowany wynik. Odbiorcy z anulowanym uchwytem są pomijani, a gdy
+ * anulują wszyscy, żądanie można porzucić. Obiekt używany jest wyłącznie w wątku głównym.
+ *
+ * @tparam T Typ sparsowanego wyniku (np. QVector<Sensor>, Measurement)
+ */
+template <typename T>
+class RequestCoalescer {
+public:
+    using Callback = std::function<void(bool, const T&)>; /**< Odbiorca wyniku */
+
+    /**
+     * @brief Rejestruje odbiorcę wyniku dla klucza
+     * @param key Znormalizowany URL żądania
+     * @param callback Funkcja odbierająca wynik
+     * @param handle Uchwyt anulowania odbiorcy
+     * @return true jeśli wywołujący jest liderem i powinien wysłać żądanie
+     */
+    bool join(const QString &key, Callback callback, const RequestHandle &handle = RequestHandle()) {
+        handle.setKey(key);
+
+        auto it = m_waiting.find(key);
+        if (it != m_waiting.end()) {
+            it->append({std::move(callback), handle});
+            ++m_coalescedCount;
+            return false;
+        }
+
+        m_waiting.insert(key, QVector<Waiter>{{std::move(callback), handle}});
+        return true;
+    }
+
+    /**
+     * @brief Porzuca żądanie, jeśli wszyscy odbiorcy anulowali
+     * @param key Znormalizowany URL żądania
+     * @return true jeśli żądanie porzucono (późniejszy complete() dla klucza należy pominąć)
+     */
+    bool abandonIfCancelled(const QString &key) {
+        auto it = m_waiting.constFind(key);
+        if (it == m_waiting.constEnd()) return false;
+
+        for (const auto &waiter : *it) {
+            if (!waiter.handle.isCancelled()) return false;
+        }
+
+        m_waiting.remove(key);
+        return true;
+    }
+
+    /**
+     * @brief Kończy żądanie i przekazuje wynik wszystkim odbiorcom
+     * @param key Znormalizowany URL żądania
+     * @param ok Czy żądanie się powiodło
+     * @param value Sparsowany wynik
+     */
+    void complete(const QString &key, bool ok, const T &value) {
+        //zdejmujemy listę przed wywołaniem - callback może zainicjować nowe żądanie o ten sam klucz
+        const QVector<Waiter> waiters = m_waiting.take(key);
+        for (const auto &waiter : waiters) {
+            if (!waiter.handle.isCancelled()) {
+                waiter.callback(ok, value);
+            }
+        }
+    }
+
+    /**
+     * @brief Zwraca liczbę różnych żądań w locie
+     * @return Liczba kluczy oczekujących na wynik
+     */
+    int inFlightCount() const { return m_waiting.size(); }
+
+    /**
+     * @brief Zwraca liczbę wywołań obsłużonych bez osobnego żądania
+     * @return Liczba połączonych wywołań
+     */
+    quint64 coalescedCount() const { return m_coalescedCount; }
+
+private:
+    /**
+     * @struct Waiter
+     * @brief Odbiorca wyniku z uchwytem anulowania
+     */
+    struct Waiter {
+        Callback callback;                       /**< Funkcja odbierająca wynik */
+        RequestHandle handle;                    /**< Uchwyt anulowania */
+    };
+
+    QHash<QString, QVector<Waiter>> m_waiting;   /**< Odbiorcy oczekujący na wynik według klucza */
+    quint64 m_coalescedCount = 0;                /**< Licznik połączonych wywołań */
+};
@@ -0,0 +1,65 @@
+/**
+ * @file requesthandle.h
+ * @brief Plik nagłówkowy zawierający definicję klasy RequestHandle
+ *
+ * Uchwyt pozwalający anulować żądanie ApiHandler
+ */
+
+#pragma once
+#include <QString>
+#include <atomic>
+#include <memory>
+
+/**
+ * @class RequestHandle
+ * @brief Współdzielony znacznik anulowania żądania
+ *
+ * Kopie uchwytu wskazują ten sam stan. Anulowany odbiorca nie otrzyma wyniku;
+ * gdy wszyscy odbiorcy danego zasobu anulują, ApiHandler przerywa żądanie sieciowe
+ * i parsowanie. Znacznik jest atomowy, więc może być sprawdzany w wątkach puli.
+ */
+class RequestHandle {
+public:
+    /**
+     * @brief Konstruktor tworzący nowy, nieanulowany uchwyt
+     */
+    RequestHandle() : m_state(std::make_shared<State>()) {}
+
+    /**
+     * @brief Oznacza uchwyt jako anulowany (bez przerywania żądania - służy do tego ApiHandler::cancel)
+     */
+    void markCancelled() const { m_state->cancelled.store(true); }
+
+    /**
+     * @brief Sprawdza, czy uchwyt został anulowany
+     * @return true jeśli anulowano
+     */
+    bool isCancelled() const { return m_state->cancelled.load(); }
+
+    /**
+     * @brief Zwraca klucz zasobu, na który czeka uchwyt
+     * @return Znormalizowany URL (pusty przed wysłaniem)
+     */
+    QString key() const { return m_state->key; }
+
+    /**
+     * @brief Ustawia klucz zasobu, na który czeka uchwyt (wątek główny)
+     * @param key Znormalizowany URL
+     */
+    void setKey(const QString &key) const { m_state->key = key; }
+
+    bool operator==(const RequestHandle &other) const { return m_state == other.m_state; }
+    bool operator!=(const RequestHandle &other) const { return m_state != other.m_state; }
+
+private:
+    /**
+     * @struct State
+     * @brief Stan współdzielony przez kopie uchwytu
+     */
+    struct State {
+        std::atomic_bool cancelled{false};  /**< Czy anulowano */
+        QString key;                        /**< Klucz zasobu (używany tylko w wątku głównym) */
+    };
+
+    std::shared_ptr<State> m_state;         /**< Stan współdzielony */
+};
@@ -0,0 +1,84 @@
+#include "TrafficController.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+
+TrafficController::TrafficController(double ratePerSecond, int initialLimit)
+    : m_rate(qBound(MinRate, ratePerSecond, MaxRate)),
+    m_limit(qBound(MinLimit, double(initialLimit), MaxLimit))
+{
+    m_tokens = m_rate;
+    m_samples.reserve(SampleCount);
+    m_clock.start();
+}
+
+void TrafficController::refill() {
+    const qint64 now = m_clock.elapsed();
+    //pojemność kubełka odpowiada sekundzie ruchu
+    m_tokens = qMin(m_rate, m_tokens + (now - m_lastRefillMs) * m_rate / 1000.0);
+    m_lastRefillMs = now;
+}
+
+bool TrafficController::tryAcquire() {
+    refill();
+    if (m_tokens < 1.0) return false;
+
+    m_tokens -= 1.0;
+    return true;
+}
+
+void TrafficController::forceAcquire() {
+    refill();
+    m_tokens -= 1.0;
+}
+
+int TrafficController::msUntilToken() {
+    refill();
+    if (m_tokens >= 1.0) return 0;
+    return int(std::ceil((1.0 - m_tokens) * 1000.0 / m_rate));
+}
+
+int TrafficController::timeoutMs() const {
+    if (m_samples.size() < MinSamples) return DefaultTimeoutMs;
+
+    //zapas ponad p99 - pojedyncze wolne odpowiedzi nie powinny być przerywane
+    return int(qBound<qint64>(MinTimeoutMs, latencyPercentile(0.99) * 3, MaxTimeoutMs));
+}
+
+qint64 TrafficController::latencyPercentile(double percentile) const {
+    if (m_samples.isEmpty()) return 0;
+
+    QVector<qint64> sorted = m_samples;
+    const int index = qBound(0, int(std::ceil(percentile * sorted.size())) - 1, int(sorted.size()) - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+void TrafficController::recordSuccess(qint64 latencyMs) {
+    //odpowiedź wyraźnie wolniejsza niż mediana - wstrzymujemy wzrost
+    const bool healthy = m_samples.size() < MinSamples || latencyMs <= 2 * latencyPercentile(0.5);
+
+    if (m_samples.size() < SampleCount) {
+        m_samples.append(latencyMs);
+    } else {
+        m_samples[m_nextSample] = latencyMs;
+    }
+    m_nextSample = (m_nextSample + 1) % SampleCount;
+
+    if (!healthy) return;
+
+    //wzrost addytywny: ok. +1 żądanie w locie na każdy pełny limit udanych odpowiedzi
+    m_limit = qMin(MaxLimit, m_limit + 1.0 / m_limit);
+    m_rate = qMin(MaxRate, m_rate + 1.0 / m_rate);
+}
+
+void TrafficController::recordCongestion() {
+    //żądania wysłane przed zmniejszeniem limitu mogą jeszcze zwracać błędy - liczymy je raz
+    const qint64 now = m_clock.elapsed();
+    if (now < m_backoffUntilMs) return;
+
+    m_limit = qMax(MinLimit, m_limit / 2.0);
+    m_rate = qMax(MinRate, m_rate / 2.0);
+    m_tokens = qMin(m_tokens, 0.0);
+    m_backoffUntilMs = now + qMax<qint64>(1000, latencyPercentile(0.9));
+}
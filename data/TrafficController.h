@@ -0,0 +1,110 @@
+/**
+ * @file trafficcontroller.h
+ * @brief Plik nagłówkowy zawierający definicję klasy TrafficController
+ *
+ * Adaptacyjny ogranicznik tempa i równoległości żądań do API GIOS
+ */
+
+#pragma once
+#include <QElapsedTimer>
+#include <QVector>
+
+/**
+ * @class TrafficController
+ * @brief Kubełek tokenów z adaptacyjnym (AIMD) limitem żądań w locie
+ *
+ * Każde wysłane żądanie zużywa token; tokeny odnawiają się ze zmiennym tempem.
+ * Dopóki opóźnienia są zdrowe, limit równoległości i tempo rosną addytywnie,
+ * a po odpowiedzi 429/5xx lub przekroczeniu czasu są zmniejszane o połowę.
+ * Limit czasu żądania wynika z obserwowanych percentyli opóźnienia.
+ * Obiekt używany jest wyłącznie w wątku głównym.
+ */
+class TrafficController {
+public:
+    /**
+     * @brief Konstruktor klasy TrafficController
+     * @param ratePerSecond Początkowe tempo żądań na sekundę
+     * @param initialLimit Początkowy limit żądań w locie
+     */
+    explicit TrafficController(double ratePerSecond = 10.0, int initialLimit = 4);
+
+    /**
+     * @brief Pobiera token, jeśli jest dostępny
+     * @return true jeśli żądanie może zostać wysłane
+     */
+    bool tryAcquire();
+
+    /**
+     * @brief Pobiera token bez czekania (saldo może stać się ujemne)
+     *
+     * Używane dla żądań interaktywnych - dług spłacają kolejne żądania tła
+     */
+    void forceAcquire();
+
+    /**
+     * @brief Zwraca czas do odnowienia kolejnego tokenu
+     * @return Czas w milisekundach (0 jeśli token jest dostępny)
+     */
+    int msUntilToken();
+
+    /**
+     * @brief Zwraca aktualny limit żądań w locie
+     * @return Limit równoległości
+     */
+    int concurrencyLimit() const { return int(m_limit); }
+
+    /**
+     * @brief Zwraca aktualne tempo odnawiania tokenów
+     * @return Liczba żądań na sekundę
+     */
+    double rate() const { return m_rate; }
+
+    /**
+     * @brief Zwraca limit czasu transferu wyznaczony z percentyli opóźnienia
+     * @return Limit czasu w milisekundach
+     */
+    int timeoutMs() const;
+
+    /**
+     * @brief Zwraca percentyl opóźnienia z ostatnich odpowiedzi
+     * @param percentile Percentyl (0..1)
+     * @return Opóźnienie w milisekundach (0 jeśli brak próbek)
+     */
+    qint64 latencyPercentile(double percentile) const;
+
+    /**
+     * @brief Księguje udaną odpowiedź
+     * @param latencyMs Czas trwania żądania
+     */
+    void recordSuccess(qint64 latencyMs);
+
+    /**
+     * @brief Księguje sygnał przeciążenia (429, 5xx, przekroczenie czasu)
+     */
+    void recordCongestion();
+
+private:
+    static constexpr double MinRate = 1.0;          /**< Minimalne tempo [żądania/s] */
+    static constexpr double MaxRate = 50.0;         /**< Maksymalne tempo [żądania/s] */
+    static constexpr double MinLimit = 1.0;         /**< Minimalny limit żądań w locie */
+    static constexpr double MaxLimit = 32.0;        /**< Maksymalny limit żądań w locie */
+    static constexpr int SampleCount = 128;         /**< Liczba zapamiętanych próbek opóźnienia */
+    static constexpr int MinSamples = 20;           /**< Próbki wymagane do wyznaczania percentyli */
+    static constexpr int DefaultTimeoutMs = 10000;  /**< Limit czasu przed zebraniem próbek */
+    static constexpr int MinTimeoutMs = 2000;       /**< Dolne ograniczenie limitu czasu */
+    static constexpr int MaxTimeoutMs = 30000;      /**< Górne ograniczenie limitu czasu */
+
+    double m_rate;                      /**< Tempo odnawiania tokenów */
+    double m_tokens;                    /**< Dostępne tokeny */
+    double m_limit;                     /**< Limit żądań w locie (ułamkowy dla przyrostu addytywnego) */
+    QElapsedTimer m_clock;              /**< Zegar odnawiania tokenów i okresu ochronnego */
+    qint64 m_lastRefillMs = 0;          /**< Czas ostatniego odnowienia tokenów */
+    qint64 m_backoffUntilMs = 0;        /**< Koniec okresu ochronnego po zmniejszeniu limitu */
+    QVector<qint64> m_samples;          /**< Bufor cykliczny próbek opóźnienia */
+    int m_nextSample = 0;               /**< Indeks kolejnej próbki w buforze */
+
+    /**
+     * @brief Dolicza tokeny odnowione od ostatniego wywołania
+     */
+    void refill();
+};
@@ -0,0 +1,108 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <functional>
+#include "Measurement.h"
+#include "MeasurementDecoder.h"
+
+namespace {
+
+constexpr qsizetype NetworkChunkSize = 16 * 1024; //typowy rozmiar fragmentu z readyRead
+
+//odpowiedź data/getData jak z API GIOS: najnowsze punkty pierwsze, co 50. wartość pusta
+QByteArray makePayload(int hours) {
+    const qint64 newest = QDateTime::currentSecsSinceEpoch() / 3600 * 3600;
+
+    QByteArray body;
+    body.reserve(qsizetype(hours) * 48 + 32);
+    body += R"({"key":"PM10","values":[)";
+    for (int h = 0; h < hours; ++h) {
+        if (h > 0) body += ',';
+        body += R"({"date":")";
+        body += QDateTime::fromSecsSinceEpoch(newest - qint64(h) * 3600).toString("yyyy-MM-dd HH:mm:ss").toLatin1();
+        body += R"(","value":)";
+        body += h % 50 == 0 ? QByteArray("null") : QByteArray::number(5.0 + (h * 37 % 900) / 10.0, 'f', 1);
+        body += '}';
+    }
+    body += "]}";
+    return body;
+}
+
+//najlepszy czas z kilku powtórzeń, wynik zapisywany do size
+double bestMs(int repetitions, const std::function<int()> &run, int &size) {
+    double best = -1.0;
+    for (int i = 0; i < repetitions; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        size = run();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (best < 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("DecoderBenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Porównanie dekodera MeasurementDecoder z QJsonDocument dla odpowiedzi data/getData");
+    parser.addHelpOption();
+
+    const QCommandLineOption daysOption("days", "Liczby dni danych godzinowych (po przecinku).", "list", "3,30,365,1825");
+    const QCommandLineOption repeatOption("repeat", "Liczba powtórzeń (liczy się najlepszy czas).", "count", "5");
+    parser.addOptions({daysOption, repeatOption});
+    parser.process(app);
+
+    const int repetitions = qMax(1, parser.value(repeatOption).toInt());
+
+    qInfo().noquote() << QString("%1 %2 %3 %4 %5")
+                             .arg("dni", 6).arg("MiB", 8).arg("QJsonDocument [ms]", 19)
+                             .arg("decode [ms]", 12).arg("strumień [ms]", 14);
+
+    for (const QString &daysText : parser.value(daysOption).split(',', Qt::SkipEmptyParts)) {
+        const int days = daysText.trimmed().toInt();
+        if (days <= 0) continue;
+
+        const QByteArray body = makePayload(days * 24);
+
+        int jsonSize = 0;
+        const double jsonMs = bestMs(repetitions, [&body]() {
+            return Measurement(QJsonDocument::fromJson(body).object()).size();
+        }, jsonSize);
+
+        int decodeSize = 0;
+        const double decodeMs = bestMs(repetitions, [&body]() {
+            Measurement measurement;
+            MeasurementDecoder::decode(body, 1, measurement);
+            return measurement.size();
+        }, decodeSize);
+
+        //fragmenty podawane jak przez NetworkWorker przy kolejnych readyRead
+        int streamSize = 0;
+        const double streamMs = bestMs(repetitions, [&body]() {
+            MeasurementDecoder decoder(1);
+            for (qsizetype offset = 0; offset < body.size(); offset += NetworkChunkSize) {
+                decoder.feed(body.mid(offset, NetworkChunkSize));
+            }
+            return decoder.finish() ? decoder.takeMeasurement().size() : -1;
+        }, streamSize);
+
+        if (jsonSize != decodeSize || jsonSize != streamSize) {
+            qCritical() << "Różna liczba punktów:" << jsonSize << decodeSize << streamSize;
+            return 1;
+        }
+
+        qInfo().noquote() << QString("%1 %2 %3 %4 %5")
+                                 .arg(days, 6).arg(body.size() / 1048576.0, 8, 'f', 2)
+                                 .arg(jsonMs, 19, 'f', 2).arg(decodeMs, 12, 'f', 2).arg(streamMs, 14, 'f', 2);
+    }
+
+    return 0;
+}
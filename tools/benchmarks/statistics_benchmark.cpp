@@ -0,0 +1,142 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QVector>
+#include <QDebug>
+#include <cmath>
+#include "SeriesStatistics.h"
+
+namespace {
+
+//kolumny jak w Measurement: najnowszy punkt pierwszy, ok. 2% punktów niepoprawnych,
+//pojedyncze NaN i brakujące czasy
+struct Columns {
+    QVector<qint64> times;
+    QVector<float> values;
+    QVector<quint64> validBits;
+};
+
+Columns makeColumns(int count) {
+    Columns columns;
+    columns.times.resize(count);
+    columns.values.resize(count);
+    columns.validBits.fill(0, (count + 63) / 64);
+
+    QRandomGenerator random(20240101);
+    const qint64 newest = 1704067200;
+    for (int i = 0; i < count; ++i) {
+        const quint32 draw = random.generate();
+        columns.times[i] = draw % 997 == 0 ? Measurement::InvalidTime : newest - qint64(i) * 3600;
+        columns.values[i] = draw % 1009 == 0 ? NAN : float(draw % 20000) / 100.0f;
+        if (draw % 50 != 0) columns.validBits[i >> 6] |= quint64(1) << (i & 63);
+    }
+    return columns;
+}
+
+//zwykła pętla z rozgałęzieniami - punkt odniesienia dla jądra
+SeriesStatistics scalarReference(const Columns &columns) {
+    SeriesStatistics stats;
+    double sum = 0, sumSquares = 0;
+    double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
+    qint64 timeOrigin = Measurement::InvalidTime;
+
+    for (int i = 0; i < columns.values.size(); ++i) {
+        const float value = columns.values[i];
+        if (!((columns.validBits[i >> 6] >> (i & 63)) & 1) || std::isnan(value)) continue;
+
+        if (stats.count == 0 || value < stats.min) { stats.min = value; stats.argMin = i; }
+        if (stats.count == 0 || value > stats.max) { stats.max = value; stats.argMax = i; }
+        ++stats.count;
+        sum += value;
+        sumSquares += double(value) * value;
+
+        const qint64 time = columns.times[i];
+        if (time == Measurement::InvalidTime) continue;
+        if (timeOrigin == Measurement::InvalidTime) timeOrigin = time;
+        const double x = double(time - timeOrigin) / 3600.0;
+        ++stats.trendCount;
+        sumX += x;
+        sumY += value;
+        sumXY += x * value;
+        sumX2 += x * x;
+    }
+
+    if (stats.count > 0) stats.mean = sum / stats.count;
+    if (stats.count > 1) stats.variance = (sumSquares - sum * sum / stats.count) / (stats.count - 1);
+    const int n = stats.trendCount;
+    const double denominator = n * sumX2 - sumX * sumX;
+    if (n > 1 && denominator != 0) stats.slopePerHour = (n * sumXY - sumX * sumY) / denominator;
+    return stats;
+}
+
+bool nearlyEqual(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::fabs(a - b) <= 1e-6 * qMax(1.0, std::fabs(b));
+}
+
+bool sameStatistics(const SeriesStatistics &kernel, const SeriesStatistics &reference) {
+    return kernel.count == reference.count && kernel.trendCount == reference.trendCount
+        && kernel.min == reference.min && kernel.max == reference.max
+        && kernel.argMin == reference.argMin && kernel.argMax == reference.argMax
+        && nearlyEqual(kernel.mean, reference.mean) && nearlyEqual(kernel.variance, reference.variance)
+        && nearlyEqual(kernel.slopePerHour, reference.slopePerHour);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("StatisticsBenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Pomiar SeriesStatistics::compute w porównaniu ze zwykłą pętlą skalarną");
+    parser.addHelpOption();
+
+    const QCommandLineOption maxPowerOption("max-power", "Największa seria: 10^N punktów (3-8).", "N", "8");
+    parser.addOption(maxPowerOption);
+    parser.process(app);
+
+    const int maxPower = qBound(3, parser.value(maxPowerOption).toInt(), 8);
+    double checksum = 0;
+    for (int power = 3; power <= maxPower; ++power) {
+        const int count = int(std::pow(10.0, power));
+        const Columns columns = makeColumns(count);
+        //małe serie powtarzane, żeby pomiar obejmował co najmniej 10^8 punktów
+        const int repeat = qMax(1, 100000000 / count);
+
+        QElapsedTimer timer;
+        SeriesStatistics kernel;
+        timer.start();
+        for (int r = 0; r < repeat; ++r) {
+            kernel = SeriesStatistics::compute(columns.times.constData(), columns.values.constData(),
+                                               columns.validBits.constData(), 0, count);
+            checksum += kernel.mean;
+        }
+        const double kernelNs = double(timer.nsecsElapsed()) / (double(repeat) * count);
+
+        SeriesStatistics reference;
+        timer.start();
+        for (int r = 0; r < repeat; ++r) {
+            reference = scalarReference(columns);
+            checksum += reference.mean;
+        }
+        const double scalarNs = double(timer.nsecsElapsed()) / (double(repeat) * count);
+
+        if (!sameStatistics(kernel, reference)) {
+            qCritical() << "Niezgodne statystyki dla" << count << "punktów:"
+                        << kernel.count << kernel.argMin << kernel.argMax << kernel.mean << "zamiast"
+                        << reference.count << reference.argMin << reference.argMax << reference.mean;
+            return 1;
+        }
+
+        qInfo().noquote() << QString("10^%1 punktów: jądro %2 ns/punkt, pętla skalarna %3 ns/punkt (%4x)")
+                                 .arg(power)
+                                 .arg(kernelNs, 6, 'f', 2)
+                                 .arg(scalarNs, 6, 'f', 2)
+                                 .arg(scalarNs / qMax(kernelNs, 0.001), 0, 'f', 2);
+    }
+    qDebug() << "Suma kontrolna:" << checksum;
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimeZone>
+#include <QDebug>
+#include "TimestampParser.h"
+
+namespace {
+
+qint64 utc(int year, int month, int day, int hour, int minute, int second) {
+    return QDateTime(QDate(year, month, day), QTime(hour, minute, second), QTimeZone::utc()).toSecsSinceEpoch();
+}
+
+struct ParseCase {
+    const char *text;
+    qint64 expected;
+    const char *note;
+};
+
+//granice czasu letniego 2024: 31 marca 02:00 -> 03:00, 27 października 03:00 -> 02:00
+int checkParseCases() {
+    const ParseCase cases[] = {
+        {"2024-03-31 01:59:59", utc(2024, 3, 31, 0, 59, 59), "ostatnia sekunda CET"},
+        {"2024-03-31 03:00:00", utc(2024, 3, 31, 1, 0, 0), "pierwsza sekunda CEST"},
+        {"2024-03-31 02:30:00", utc(2024, 3, 31, 1, 30, 0), "godzina nieistniejąca - jak CET"},
+        {"2024-10-27 01:59:59", utc(2024, 10, 26, 23, 59, 59), "przed godziną powtarzaną"},
+        {"2024-10-27 02:00:00", utc(2024, 10, 27, 0, 0, 0), "godzina powtarzana - pierwsze wystąpienie"},
+        {"2024-10-27 02:59:59", utc(2024, 10, 27, 0, 59, 59), "koniec pierwszego wystąpienia"},
+        {"2024-10-27 03:00:00", utc(2024, 10, 27, 2, 0, 0), "pierwsza pełna godzina CET"},
+        {"2024-01-01 00:00:00", utc(2023, 12, 31, 23, 0, 0), "przełom roku CET"},
+        {"2024-07-01T12:00", utc(2024, 7, 1, 10, 0, 0), "ISO bez sekund, CEST"},
+        {"2024-07-01T12:00:00.250", utc(2024, 7, 1, 10, 0, 0), "ułamek sekundy"},
+        {"2024-10-27T02:00:00Z", utc(2024, 10, 27, 2, 0, 0), "UTC"},
+        {"2024-10-27T02:00:00+01:00", utc(2024, 10, 27, 1, 0, 0), "jawne przesunięcie"},
+        {"2024-10-27T02:00:00-0230", utc(2024, 10, 27, 4, 30, 0), "ujemne przesunięcie bez dwukropka"},
+        {"2024-02-29 10:00:00", utc(2024, 2, 29, 9, 0, 0), "rok przestępny"},
+        {"2023-02-29 10:00:00", TimestampParser::Invalid, "29 lutego w roku zwykłym"},
+        {"2024-13-01 10:00:00", TimestampParser::Invalid, "miesiąc spoza zakresu"},
+        {"2024-10-27 24:00:00", TimestampParser::Invalid, "godzina spoza zakresu"},
+        {"2024-10-27", TimestampParser::Invalid, "sama data"},
+        {"2024-10-27T02:00:00+1", TimestampParser::Invalid, "niepełne przesunięcie"},
+    };
+
+    int failures = 0;
+    for (const ParseCase &c : cases) {
+        const qint64 parsed = TimestampParser::parse(QString::fromLatin1(c.text));
+        if (parsed != c.expected) {
+            qCritical().noquote() << QString("BŁĄD %1 (%2): %3 zamiast %4")
+                                         .arg(c.text, c.note).arg(parsed).arg(c.expected);
+            ++failures;
+        }
+    }
+
+    struct OffsetCase { qint64 utcSecs; int expected; };
+    const OffsetCase offsets[] = {
+        {utc(2024, 3, 31, 0, 59, 59), 3600},
+        {utc(2024, 3, 31, 1, 0, 0), 7200},
+        {utc(2024, 10, 27, 0, 59, 59), 7200},
+        {utc(2024, 10, 27, 1, 0, 0), 3600},
+    };
+    for (const OffsetCase &c : offsets) {
+        if (TimestampParser::warsawOffsetSecs(c.utcSecs) != c.expected) {
+            qCritical() << "BŁĄD przesunięcia dla" << c.utcSecs << ":"
+                        << TimestampParser::warsawOffsetSecs(c.utcSecs) << "zamiast" << c.expected;
+            ++failures;
+        }
+    }
+
+    //22:00 UTC 26 października to już 27 października w Polsce (CEST)
+    const qint64 day = TimestampParser::warsawDay(utc(2024, 10, 26, 22, 0, 0));
+    if (day != TimestampParser::daysFromCivil(2024, 10, 27)) {
+        qCritical() << "BŁĄD dnia lokalnego:" << day;
+        ++failures;
+    }
+
+    return failures;
+}
+
+//każda godzina kilku lat porównana z bazą stref czasowych Qt
+int checkAgainstTimeZone() {
+    const QTimeZone warsaw("Europe/Warsaw");
+    if (!warsaw.isValid()) {
+        qWarning() << "Brak strefy Europe/Warsaw w systemie - pominięto porównanie z QTimeZone";
+        return 0;
+    }
+
+    int failures = 0;
+    for (qint64 t = utc(2000, 1, 1, 0, 0, 0); t < utc(2040, 1, 1, 0, 0, 0); t += 1800) {
+        const QDateTime local = QDateTime::fromSecsSinceEpoch(t, warsaw);
+        const int offset = local.offsetFromUtc();
+        if (TimestampParser::warsawOffsetSecs(t) != offset) {
+            if (++failures <= 10) qCritical() << "BŁĄD przesunięcia:" << local.toString(Qt::ISODate);
+            continue;
+        }
+
+        //drugie wystąpienie godziny powtarzanej parser przypisuje pierwszemu
+        const qint64 parsed = TimestampParser::parse(local.toString("yyyy-MM-dd HH:mm:ss"));
+        const bool repeated = offset == 3600 && TimestampParser::warsawOffsetSecs(t - 3600) == 7200;
+        if (parsed != (repeated ? t - 3600 : t)) {
+            if (++failures <= 10) qCritical() << "BŁĄD parsowania:" << local.toString(Qt::ISODate) << parsed;
+        }
+    }
+    return failures;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("TimestampBenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sprawdzenie i pomiar TimestampParser w porównaniu z QDateTime::fromString");
+    parser.addHelpOption();
+
+    const QCommandLineOption countOption("count", "Liczba parsowanych znaczników czasu.", "count", "1000000");
+    parser.addOption(countOption);
+    parser.process(app);
+
+    const int failures = checkParseCases() + checkAgainstTimeZone();
+    if (failures > 0) {
+        qCritical() << "Niezgodności:" << failures;
+        return 1;
+    }
+    qInfo() << "Przypadki graniczne czasu letniego: OK";
+
+    //znaczniki kolejnych godzin, jak w odpowiedziach data/getData
+    const int count = qMax(1, parser.value(countOption).toInt());
+    const qint64 newest = QDateTime::currentSecsSinceEpoch() / 3600 * 3600;
+    QVector<QByteArray> latin;
+    QVector<QString> texts;
+    latin.reserve(count);
+    texts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        texts.append(QDateTime::fromSecsSinceEpoch(newest - qint64(i % 87600) * 3600).toString("yyyy-MM-dd HH:mm:ss"));
+        latin.append(texts.last().toLatin1());
+    }
+
+    qint64 checksum = 0;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (const QByteArray &text : latin) checksum += TimestampParser::parse(text.constData(), text.size());
+    const double bytesNs = double(timer.nsecsElapsed()) / count;
+
+    timer.start();
+    for (const QString &text : texts) checksum += TimestampParser::parse(text);
+    const double stringNs = double(timer.nsecsElapsed()) / count;
+
+    timer.start();
+    for (const QString &text : texts) {
+        checksum += QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss").toSecsSinceEpoch();
+    }
+    const double qtNs = double(timer.nsecsElapsed()) / count;
+
+    qInfo().noquote() << QString("TimestampParser (bajty):  %1 ns").arg(bytesNs, 8, 'f', 1);
+    qInfo().noquote() << QString("TimestampParser (QString): %1 ns").arg(stringNs, 8, 'f', 1);
+    qInfo().noquote() << QString("QDateTime::fromString:    %1 ns (%2x wolniej)")
+                             .arg(qtNs, 8, 'f', 1).arg(qtNs / qMax(stringNs, 0.001), 0, 'f', 1);
+    qDebug() << "Suma kontrolna:" << checksum;
+
+    return 0;
+}
@@ -0,0 +1,391 @@
+#include "StubServer.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QTimeZone>
+#include <QUrl>
+#include <QDebug>
+#include <cmath>
+
+namespace {
+
+struct StubParam {
+    const char *name;
+    const char *formula;
+    const char *code;
+    int id;
+    double base; //typowy poziom stężenia
+};
+
+const StubParam Params[] = {
+    {"pył zawieszony PM10", "PM10", "PM10", 3, 30.0},
+    {"pył zawieszony PM2.5", "PM2.5", "PM2.5", 69, 20.0},
+    {"dwutlenek azotu", "NO2", "NO2", 6, 25.0},
+    {"ozon", "O3", "O3", 5, 60.0},
+    {"dwutlenek siarki", "SO2", "SO2", 1, 5.0},
+    {"tlenek węgla", "CO", "CO", 8, 400.0},
+    {"benzen", "C6H6", "C6H6", 10, 1.0},
+};
+constexpr int ParamCount = int(sizeof(Params) / sizeof(Params[0]));
+
+struct StubCity {
+    const char *name;
+    double lat;
+    double lon;
+    const char *province;
+};
+
+const StubCity Cities[] = {
+    {"Warszawa", 52.2297, 21.0122, "MAZOWIECKIE"},
+    {"Kraków", 50.0647, 19.9450, "MAŁOPOLSKIE"},
+    {"Łódź", 51.7592, 19.4560, "ŁÓDZKIE"},
+    {"Wrocław", 51.1079, 17.0385, "DOLNOŚLĄSKIE"},
+    {"Poznań", 52.4064, 16.9252, "WIELKOPOLSKIE"},
+    {"Gdańsk", 54.3520, 18.6466, "POMORSKIE"},
+    {"Szczecin", 53.4285, 14.5528, "ZACHODNIOPOMORSKIE"},
+    {"Bydgoszcz", 53.1235, 18.0084, "KUJAWSKO-POMORSKIE"},
+    {"Lublin", 51.2465, 22.5684, "LUBELSKIE"},
+    {"Białystok", 53.1325, 23.1688, "PODLASKIE"},
+    {"Katowice", 50.2649, 19.0238, "ŚLĄSKIE"},
+    {"Kielce", 50.8661, 20.6286, "ŚWIĘTOKRZYSKIE"},
+    {"Rzeszów", 50.0412, 21.9991, "PODKARPACKIE"},
+    {"Olsztyn", 53.7784, 20.4801, "WARMIŃSKO-MAZURSKIE"},
+    {"Opole", 50.6751, 17.9213, "OPOLSKIE"},
+    {"Zielona Góra", 51.9356, 15.5062, "LUBUSKIE"},
+};
+constexpr int CityCount = int(sizeof(Cities) / sizeof(Cities[0]));
+
+const char *const IndexLevelNames[] = {
+    "Bardzo dobry", "Dobry", "Umiarkowany", "Dostateczny", "Zły", "Bardzo zły"
+};
+
+constexpr int FirstStationId = 100;
+constexpr double Pi = 3.14159265358979323846;
+
+int paramIndex(int sensorId) {
+    return (sensorId % 10) % ParamCount;
+}
+
+//daty w odpowiedziach jak w API GIOS - czas lokalny Polski, niezależnie od strefy hosta
+QDateTime warsawTime(qint64 epochSecs) {
+    static const QTimeZone zone("Europe/Warsaw");
+    return QDateTime::fromSecsSinceEpoch(epochSecs, zone);
+}
+
+QByteArray reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Status";
+    }
+}
+
+}
+
+StubServer::StubServer(const StubConfig &config, QObject *parent)
+    : QObject(parent),
+    m_config(config)
+{
+    m_config.sensorsPerStation = qBound(1, m_config.sensorsPerStation, ParamCount);
+    connect(&m_server, &QTcpServer::newConnection, this, &StubServer::handleNewConnection);
+}
+
+bool StubServer::listen() {
+    return m_server.listen(QHostAddress::Any, m_config.port);
+}
+
+void StubServer::handleNewConnection() {
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            handleReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void StubServer::handleReadyRead(QTcpSocket *socket) {
+    QByteArray buffer = m_buffers.take(socket) + socket->readAll();
+
+    qsizetype headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        const QByteArray head = buffer.left(headerEnd);
+        buffer.remove(0, headerEnd + 4);
+
+        const QList<QByteArray> lines = head.split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        if (requestLine.size() < 3) {
+            sendResponse(socket, {400, R"({"error":"bad request"})"}, false);
+            return;
+        }
+
+        bool keepAlive = requestLine[2] == "HTTP/1.1";
+        QByteArray ifNoneMatch;
+        for (int i = 1; i < lines.size(); ++i) {
+            const QByteArray header = lines[i].trimmed();
+            const QByteArray name = header.left(header.indexOf(':')).trimmed().toLower();
+            const QByteArray value = header.mid(header.indexOf(':') + 1).trimmed();
+            if (name == "connection") {
+                keepAlive = !value.toLower().contains("close");
+            } else if (name == "if-none-match") {
+                ifNoneMatch = value;
+            }
+        }
+
+        ++m_requestCount;
+        const QUrl url(QString::fromLatin1(requestLine[1]));
+
+        Response response;
+        if (requestLine[0] != "GET") {
+            response = {405, R"({"error":"method not allowed"})"};
+        } else if (m_config.errorRate > 0.0 &&
+                   QRandomGenerator::global()->generateDouble() < m_config.errorRate) {
+            response = {m_config.errorStatus, R"({"error":"injected"})"};
+        } else {
+            response = route(url.path(), QUrlQuery(url));
+            if (response.status == 200) {
+                response.etag = '"' + QCryptographicHash::hash(response.body, QCryptographicHash::Sha1).toHex().left(16) + '"';
+                if (ifNoneMatch == response.etag) {
+                    response.status = 304;
+                    response.body.clear();
+                }
+            }
+        }
+
+        if (m_config.verbose) {
+            qInfo().noquote() << m_requestCount << requestLine[1] << "->" << response.status
+                              << response.body.size() << "B";
+        }
+
+        const int delay = m_config.latencyMs +
+                          (m_config.jitterMs > 0 ? int(QRandomGenerator::global()->bounded(m_config.jitterMs + 1)) : 0);
+        if (delay > 0) {
+            QTimer::singleShot(delay, socket, [this, socket, response, keepAlive]() {
+                sendResponse(socket, response, keepAlive);
+            });
+        } else {
+            sendResponse(socket, response, keepAlive);
+        }
+
+        if (!keepAlive) return;
+    }
+
+    if (socket->state() == QAbstractSocket::ConnectedState) {
+        m_buffers.insert(socket, buffer);
+    }
+}
+
+StubServer::Response StubServer::route(const QString &path, const QUrlQuery &query) {
+    static const QRegularExpression sensorsPattern("station/sensors/(\\d+)/?$");
+    static const QRegularExpression dataPattern("data/getData/(\\d+)/?$");
+    static const QRegularExpression indexPattern("aqindex/getIndex/(\\d+)/?$");
+
+    //ścieżka endpointu bez prefiksu (np. /pjp-api/rest/)
+    QString endpoint;
+    int id = 0;
+    QRegularExpressionMatch match;
+
+    if (path.endsWith("station/findAll") || path.endsWith("station/findAll/")) {
+        endpoint = "station/findAll";
+    } else if ((match = sensorsPattern.match(path)).hasMatch()) {
+        id = match.captured(1).toInt();
+        endpoint = QString("station/sensors/%1").arg(id);
+    } else if ((match = dataPattern.match(path)).hasMatch()) {
+        id = match.captured(1).toInt();
+        endpoint = QString("data/getData/%1").arg(id);
+    } else if ((match = indexPattern.match(path)).hasMatch()) {
+        id = match.captured(1).toInt();
+        endpoint = QString("aqindex/getIndex/%1").arg(id);
+    } else {
+        return {404, R"({"error":"unknown endpoint"})"};
+    }
+
+    const QByteArray recorded = fixture(endpoint);
+    if (!recorded.isEmpty()) {
+        return {200, recorded};
+    }
+
+    if (endpoint == "station/findAll") return {200, stationsJson()};
+
+    const bool knownStation = id >= FirstStationId && id < FirstStationId + m_config.stationCount;
+    if (endpoint.startsWith("station/sensors/")) {
+        return knownStation ? Response{200, sensorsJson(id)} : Response{200, "[]"};
+    }
+    if (endpoint.startsWith("aqindex/")) {
+        return knownStation ? Response{200, indexJson(id)} : Response{404, R"({"error":"unknown station"})"};
+    }
+
+    const int stationId = id / 10;
+    const bool knownSensor = stationId >= FirstStationId &&
+                             stationId < FirstStationId + m_config.stationCount &&
+                             id % 10 < m_config.sensorsPerStation;
+    return knownSensor ? Response{200, dataJson(id, query)} : Response{404, R"({"error":"unknown sensor"})"};
+}
+
+void StubServer::sendResponse(QTcpSocket *socket, const Response &response, bool keepAlive) {
+    if (socket->state() != QAbstractSocket::ConnectedState) return;
+
+    QByteArray head;
+    head += "HTTP/1.1 " + QByteArray::number(response.status) + " " + reasonPhrase(response.status) + "\r\n";
+    head += "Content-Type: application/json; charset=UTF-8\r\n";
+    head += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    if (!response.etag.isEmpty()) {
+        head += "ETag: " + response.etag + "\r\n";
+    }
+    head += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    head += "\r\n";
+
+    socket->write(head);
+    socket->write(response.body);
+
+    if (!keepAlive) {
+        socket->disconnectFromHost();
+    }
+}
+
+QByteArray StubServer::fixture(const QString &endpoint) const {
+    if (m_config.fixturesDir.isEmpty()) return QByteArray();
+
+    QFile file(QDir(m_config.fixturesDir).filePath(endpoint + ".json"));
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+QByteArray StubServer::stationsJson() {
+    if (!m_stationsCache.isEmpty()) return m_stationsCache;
+
+    QJsonArray stations;
+    for (int i = 0; i < m_config.stationCount; ++i) {
+        const int id = FirstStationId + i;
+        const StubCity &city = Cities[i % CityCount];
+
+        //kolejne stacje miasta rozkładamy na okręgu wokół centrum
+        const int ring = i / CityCount;
+        const double angle = ring * 2.399963; //złoty kąt
+        const double radius = 0.02 * std::sqrt(double(ring));
+
+        QJsonObject commune;
+        commune["communeName"] = QString::fromUtf8(city.name);
+        commune["districtName"] = QString::fromUtf8(city.name);
+        commune["provinceName"] = QString::fromUtf8(city.province);
+
+        QJsonObject cityObj;
+        cityObj["id"] = 1000 + i % CityCount;
+        cityObj["name"] = QString::fromUtf8(city.name);
+        cityObj["commune"] = commune;
+
+        QJsonObject station;
+        station["id"] = id;
+        station["stationName"] = QString("%1, stacja %2").arg(QString::fromUtf8(city.name)).arg(ring + 1);
+        station["gegrLat"] = QString::number(city.lat + radius * std::sin(angle), 'f', 6);
+        station["gegrLon"] = QString::number(city.lon + radius * std::cos(angle), 'f', 6);
+        station["city"] = cityObj;
+        station["addressStreet"] = QString("ul. Pomiarowa %1").arg(ring + 1);
+
+        stations.append(station);
+    }
+
+    m_stationsCache = QJsonDocument(stations).toJson(QJsonDocument::Compact);
+    return m_stationsCache;
+}
+
+QByteArray StubServer::sensorsJson(int stationId) const {
+    QJsonArray sensors;
+    for (int k = 0; k < m_config.sensorsPerStation; ++k) {
+        const int sensorId = stationId * 10 + k;
+        const StubParam &param = Params[paramIndex(sensorId)];
+
+        QJsonObject paramObj;
+        paramObj["paramName"] = QString::fromUtf8(param.name);
+        paramObj["paramFormula"] = QString::fromUtf8(param.formula);
+        paramObj["paramCode"] = QString::fromUtf8(param.code);
+        paramObj["idParam"] = param.id;
+
+        QJsonObject sensor;
+        sensor["id"] = sensorId;
+        sensor["stationId"] = stationId;
+        sensor["param"] = paramObj;
+        sensors.append(sensor);
+    }
+    return QJsonDocument(sensors).toJson(QJsonDocument::Compact);
+}
+
+QByteArray StubServer::dataJson(int sensorId, const QUrlQuery &query) const {
+    const QDateTime from = QDateTime::fromString(query.queryItemValue("from"), Qt::ISODate);
+    const QDateTime to = QDateTime::fromString(query.queryItemValue("to"), Qt::ISODate);
+
+    const qint64 nowHour = QDateTime::currentSecsSinceEpoch() / 3600;
+
+    //jak API GIOS: najnowsze punkty pierwsze, dwie ostatnie godziny jeszcze bez wartości
+    QJsonArray values;
+    for (int h = 0; h < m_config.hours; ++h) {
+        const qint64 hourEpoch = nowHour - h;
+        const QDateTime time = warsawTime(hourEpoch * 3600);
+        if (from.isValid() && time < from) break;
+        if (to.isValid() && time > to) continue;
+
+        QJsonObject point;
+        point["date"] = time.toString("yyyy-MM-dd HH:mm:ss");
+        point["value"] = h < 2 ? QJsonValue() : QJsonValue(syntheticValue(sensorId, hourEpoch));
+        values.append(point);
+    }
+
+    QJsonObject root;
+    root["key"] = QString::fromUtf8(Params[paramIndex(sensorId)].code);
+    root["values"] = values;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QByteArray StubServer::indexJson(int stationId) const {
+    const qint64 hourEpoch = QDateTime::currentSecsSinceEpoch() / 3600 - 2;
+    const double pm10 = syntheticValue(stationId * 10, hourEpoch) * Params[0].base / Params[paramIndex(stationId * 10)].base;
+
+    //progi PM10 indeksu GIOS
+    const double thresholds[] = {20.0, 50.0, 80.0, 110.0, 150.0};
+    int level = 0;
+    while (level < 5 && pm10 > thresholds[level]) ++level;
+
+    const QString calcDate = warsawTime(hourEpoch * 3600 + 1200).toString("yyyy-MM-ddTHH:mm:ss");
+    const QString sourceDate = warsawTime(hourEpoch * 3600).toString("yyyy-MM-ddTHH:mm:ss");
+
+    QJsonObject levelObj;
+    levelObj["id"] = level;
+    levelObj["indexLevelName"] = QString::fromUtf8(IndexLevelNames[level]);
+
+    QJsonObject index;
+    index["id"] = stationId;
+    index["stCalcDate"] = calcDate;
+    index["stSourceDataDate"] = sourceDate;
+    index["stIndexLevel"] = levelObj;
+    index["stations"] = QJsonArray();
+    return QJsonDocument(index).toJson(QJsonDocument::Compact);
+}
+
+double StubServer::syntheticValue(int sensorId, qint64 hourEpoch) const {
+    const StubParam &param = Params[paramIndex(sensorId)];
+
+    //wartość zależy tylko od czujnika i godziny - powtarzalna między żądaniami
+    QRandomGenerator generator(m_config.seed ^ (quint32(sensorId) * 2654435761u) ^ (quint32(hourEpoch) * 40503u));
+    const double hourOfDay = double(hourEpoch % 24);
+    const double daily = 1.0 + 0.4 * std::sin((hourOfDay - 6.0) / 24.0 * 2.0 * Pi);
+    const double noise = 0.7 + 0.6 * generator.generateDouble();
+
+    return std::round(param.base * daily * noise * 100.0) / 100.0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file stubserver.h
+ * @brief Plik nagłówkowy zawierający definicję klasy StubServer
+ *
+ * Lokalny serwer HTTP zastępujący API GIOS w testach obciążeniowych i pracy offline
+ */
+
+#pragma once
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QUrlQuery>
+
+/**
+ * @struct StubConfig
+ * @brief Konfiguracja serwera zastępczego
+ */
+struct StubConfig {
+    quint16 port = 8080;            /**< Port nasłuchu */
+    int latencyMs = 0;              /**< Stałe opóźnienie odpowiedzi */
+    int jitterMs = 0;               /**< Losowe dodatkowe opóźnienie (0..jitterMs) */
+    double errorRate = 0.0;         /**< Prawdopodobieństwo odpowiedzi z błędem (0..1) */
+    int errorStatus = 503;          /**< Kod HTTP zwracany przy wstrzykniętym błędzie */
+    int stationCount = 270;         /**< Liczba syntetycznych stacji */
+    int sensorsPerStation = 5;      /**< Liczba czujników na stację (1..7) */
+    int hours = 72;                 /**< Liczba godzin danych w odpowiedzi data/getData */
+    QString fixturesDir;            /**< Katalog z nagranymi odpowiedziami (opcjonalny) */
+    quint32 seed = 1;               /**< Ziarno generatora danych syntetycznych */
+    bool verbose = false;           /**< Czy logować każde żądanie */
+};
+
+/**
+ * @class StubServer
+ * @brief Serwer HTTP/1.1 obsługujący endpointy API GIOS
+ *
+ * Obsługuje station/findAll, station/sensors/{id}, data/getData/{id} oraz
+ * aqindex/getIndex/{id} pod dowolnym prefiksem ścieżki. Odpowiedzi pochodzą z
+ * katalogu fixtures (o strukturze odpowiadającej ścieżkom endpointów) lub są
+ * generowane deterministycznie. Połączenia keep-alive są utrzymywane, a opóźnienie
+ * i błędy można konfigurować. Odpowiedzi mają ETag, a żądania warunkowe
+ * (If-None-Match) z aktualnym walidatorem otrzymują 304.
+ */
+class StubServer : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Konstruktor klasy StubServer
+     * @param config Konfiguracja serwera
+     * @param parent Wskaźnik na obiekt rodzica (domyślnie nullptr)
+     */
+    explicit StubServer(const StubConfig &config, QObject *parent = nullptr);
+
+    /**
+     * @brief Rozpoczyna nasłuch na skonfigurowanym porcie
+     * @return true jeśli serwer nasłuchuje
+     */
+    bool listen();
+
+    /**
+     * @brief Zwraca opis ostatniego błędu serwera
+     * @return Komunikat błędu
+     */
+    QString errorString() const { return m_server.errorString(); }
+
+private slots:
+    /**
+     * @brief Slot obsługujący nowe połączenie
+     */
+    void handleNewConnection();
+
+private:
+    /**
+     * @struct Response
+     * @brief Odpowiedź HTTP przygotowana do wysłania
+     */
+    struct Response {
+        int status = 200;       /**< Kod statusu HTTP */
+        QByteArray body;        /**< Treść odpowiedzi */
+        QByteArray etag;        /**< Nagłówek ETag (pusty jeśli brak) */
+    };
+
+    StubConfig m_config;                        /**< Konfiguracja serwera */
+    QTcpServer m_server;                        /**< Gniazdo nasłuchujące */
+    QHash<QTcpSocket*, QByteArray> m_buffers;   /**< Niepełne żądania według połączenia */
+    QByteArray m_stationsCache;                 /**< Wygenerowana lista stacji */
+    quint64 m_requestCount = 0;                 /**< Liczba obsłużonych żądań */
+
+    /**
+     * @brief Przetwarza kompletne żądania z bufora połączenia
+     * @param socket Gniazdo klienta
+     */
+    void handleReadyRead(QTcpSocket *socket);
+
+    /**
+     * @brief Wyznacza odpowiedź dla ścieżki żądania
+     * @param path Ścieżka URL
+     * @param query Parametry zapytania
+     * @return Odpowiedź HTTP
+     */
+    Response route(const QString &path, const QUrlQuery &query);
+
+    /**
+     * @brief Wysyła odpowiedź do klienta
+     * @param socket Gniazdo klienta
+     * @param response Odpowiedź
+     * @param keepAlive Czy utrzymać połączenie
+     */
+    void sendResponse(QTcpSocket *socket, const Response &response, bool keepAlive);
+
+    /**
+     * @brief Odczytuje nagraną odpowiedź z katalogu fixtures
+     * @param endpoint Ścieżka endpointu (np. "data/getData/123")
+     * @return Treść pliku lub pusty QByteArray gdy brak
+     */
+    QByteArray fixture(const QString &endpoint) const;
+
+    QByteArray stationsJson();                                    /**< Syntetyczna lista stacji */
+    QByteArray sensorsJson(int stationId) const;                  /**< Syntetyczne czujniki stacji */
+    QByteArray dataJson(int sensorId, const QUrlQuery &query) const; /**< Syntetyczne pomiary czujnika */
+    QByteArray indexJson(int stationId) const;                    /**< Syntetyczny indeks stacji */
+
+    /**
+     * @brief Zwraca deterministyczną wartość pomiaru czujnika w danej godzinie
+     * @param sensorId ID czujnika
+     * @param hourEpoch Numer godziny od epoki Unix
+     * @return Wartość pomiaru
+     */
+    double syntheticValue(int sensorId, qint64 hourEpoch) const;
+};
@@ -0,0 +1,53 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include "StubServer.h"
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("GiosStubServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Lokalny serwer zastępczy API GIOS");
+    parser.addHelpOption();
+
+    const QCommandLineOption portOption("port", "Port nasłuchu.", "port", "8080");
+    const QCommandLineOption latencyOption("latency", "Stałe opóźnienie odpowiedzi [ms].", "ms", "0");
+    const QCommandLineOption jitterOption("jitter", "Losowe dodatkowe opóźnienie [ms].", "ms", "0");
+    const QCommandLineOption errorRateOption("error-rate", "Odsetek odpowiedzi z błędem (0..1).", "rate", "0");
+    const QCommandLineOption errorStatusOption("error-status", "Kod HTTP wstrzykiwanych błędów.", "status", "503");
+    const QCommandLineOption stationsOption("stations", "Liczba syntetycznych stacji.", "count", "270");
+    const QCommandLineOption sensorsOption("sensors", "Liczba czujników na stację (1..7).", "count", "5");
+    const QCommandLineOption hoursOption("hours", "Liczba godzin danych pomiarowych.", "hours", "72");
+    const QCommandLineOption fixturesOption("fixtures", "Katalog z nagranymi odpowiedziami.", "dir");
+    const QCommandLineOption seedOption("seed", "Ziarno danych syntetycznych.", "seed", "1");
+    const QCommandLineOption verboseOption("verbose", "Loguje każde żądanie.");
+
+    parser.addOptions({portOption, latencyOption, jitterOption, errorRateOption, errorStatusOption,
+                       stationsOption, sensorsOption, hoursOption, fixturesOption, seedOption, verboseOption});
+    parser.process(app);
+
+    StubConfig config;
+    config.port = quint16(parser.value(portOption).toUInt());
+    config.latencyMs = qMax(0, parser.value(latencyOption).toInt());
+    config.jitterMs = qMax(0, parser.value(jitterOption).toInt());
+    config.errorRate = qBound(0.0, parser.value(errorRateOption).toDouble(), 1.0);
+    config.errorStatus = parser.value(errorStatusOption).toInt();
+    config.stationCount = qMax(0, parser.value(stationsOption).toInt());
+    config.sensorsPerStation = parser.value(sensorsOption).toInt();
+    config.hours = qMax(0, parser.value(hoursOption).toInt());
+    config.fixturesDir = parser.value(fixturesOption);
+    config.seed = parser.value(seedOption).toUInt();
+    config.verbose = parser.isSet(verboseOption);
+
+    StubServer server(config);
+    if (!server.listen()) {
+        qCritical() << "Nie można uruchomić serwera:" << server.errorString();
+        return 1;
+    }
+
+    qInfo().noquote() << QString("Serwer zastępczy GIOS: http://127.0.0.1:%1/pjp-api/rest").arg(config.port);
+    qInfo().noquote() << "Uruchom aplikację z GIOS_API_URL ustawionym na powyższy adres.";
+
+    return app.exec();
+}
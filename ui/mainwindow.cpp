@@ -1,5 +1,9 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "AirQualityCalculator.h"
+#include "AnomalyDetector.h"
+#include "StationDistances.h"
+#include "PollutionHeatmap.h"
 #include <QDebug>
 #include <QMessageBox>
 #include <QDateTime>
@@ -10,6 +14,12 @@
 #include <QNetworkInterface>
 #include <QtConcurrent>
 #include <QFutureWatcher>
+#include <QInputDialog>
+#include <QDialog>
+#include <QVBoxLayout>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <numeric>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -73,6 +83,7 @@ MainWindow::MainWindow(QWidget *parent)
     //podlaczenie przycisków
     connect(ui->refreshButton, &QPushButton::clicked, this, &MainWindow::handleRefreshClicked);
     connect(ui->filterButton, &QPushButton::clicked, this, &MainWindow::handleFilterClicked);
+    connect(ui->cityFilterEdit, &QLineEdit::textChanged, this, &MainWindow::applyStationFilter);
     connect(ui->searchNearbyButton, &QPushButton::clicked, this, &MainWindow::handleSearchNearby);
     connect(ui->timeToolBar->findChild<QPushButton*>("applyDateRangeButton"), &QPushButton::clicked, this, &MainWindow::handleDateRangeApplied);
 
@@ -89,6 +100,25 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_apiHandler, &ApiHandler::stationsFiltered, this, &MainWindow::displayStations);
     connect(m_apiHandler, &ApiHandler::geocodingFinished, this, &MainWindow::handleGeocodingResult);
     connect(m_apiHandler, &ApiHandler::geocodingError, this, &MainWindow::handleGeocodingError);
+    connect(m_apiHandler, &ApiHandler::crawlProgress, this, &MainWindow::handleCrawlProgress);
+    connect(m_apiHandler, &ApiHandler::crawlFinished, this, &MainWindow::handleCrawlFinished);
+
+    //cykliczna aktualizacja wszystkich stacji
+    QAction *crawlAction = ui->toolBar->addAction("Aktualizuj wszystkie stacje co godzinę");
+    crawlAction->setCheckable(true);
+    connect(crawlAction, &QAction::toggled, this, &MainWindow::handleCrawlToggled);
+
+    //raport przekroczeń norm dla wyświetlanego zakresu
+    QAction *exceedanceAction = ui->toolBar->addAction("Raport przekroczeń norm");
+    connect(exceedanceAction, &QAction::triggered, this, &MainWindow::handleExceedanceReport);
+
+    //porównanie wszystkich czujników wybranej stacji
+    QAction *comparisonAction = ui->toolBar->addAction("Porównaj czujniki stacji");
+    connect(comparisonAction, &QAction::triggered, this, &MainWindow::handleStationComparison);
+
+    //mapa stężeń interpolowana z wartości wszystkich stacji
+    QAction *mapAction = ui->toolBar->addAction("Mapa zanieczyszczeń");
+    connect(mapAction, &QAction::triggered, this, &MainWindow::handlePollutionMap);
 
 
     //konfiguracja ui
@@ -144,28 +174,42 @@ void MainWindow::handleRefreshClicked() {
 
 void MainWindow::handleFilterClicked()
 {
-    QString city = ui->cityFilterEdit->text().trimmed();
-    if (city.isEmpty()) {
+    QString query = ui->cityFilterEdit->text().trimmed();
+    applyStationFilter(query);
+    if (!query.isEmpty()) {
+        logMessage(QString("Zastosowano filtr stacji: %1").arg(query));
+    }
+}
+
+void MainWindow::applyStationFilter(const QString& query)
+{
+    //wyszukiwanie przy każdym naciśnięciu klawisza - indeks zamiast przeglądania stacji
+    if (query.trimmed().isEmpty()) {
         displayStations(m_allStations);
         return;
     }
-
-    QVector<Station> filtered;
-    std::copy_if(m_allStations.begin(), m_allStations.end(), std::back_inserter(filtered),
-                 [city](const Station& s) {
-                     return s.cityName().contains(city, Qt::CaseInsensitive);
-                 });
-
-    displayStations(filtered);
-    logMessage(QString("Zastosowano filtr według miasta: %1").arg(city));
+    displayStations(m_apiHandler->searchStations(query));
 }
 
 
 void MainWindow::handleStationClicked(QListWidgetItem *item)
 {
     int stationId = item->data(Qt::UserRole).toInt();
+
+    //pomiary czujnika poprzedniej stacji nie są już potrzebne
+    m_apiHandler->cancel(m_measurementsRequest);
+
     m_apiHandler->fetchSensors(stationId);
-    m_apiHandler->fetchAirQualityIndex(stationId);
+
+    //indeks z zapisanych pomiarów, zapytanie aqindex tylko gdy brak lokalnych danych
+    const QDateTime from = QDateTime::currentDateTime().addSecs(-6 * 3600);
+    const AirQualityIndex localIndex = AirQualityCalculator::latest(
+        stationId, databaseManager()->loadStationSeries({stationId}, from, QDateTime()).value(stationId));
+    if (localIndex.isValid()) {
+        displayAirQuality(localIndex);
+    } else {
+        m_apiHandler->fetchAirQualityIndex(stationId);
+    }
     logMessage(QString("Wybrana stacja ID: %1").arg(stationId));
 }
 
@@ -174,7 +218,170 @@ void MainWindow::handleSensorClicked(QListWidgetItem *item)
     if (!item) return;
 
     int sensorId = item->data(Qt::UserRole).toInt();
-    m_apiHandler->fetchMeasurements(sensorId, QDateTime(), QDateTime());
+    m_measurementsRequest = m_apiHandler->fetchMeasurements(sensorId, QDateTime(), QDateTime());
+}
+
+
+void MainWindow::handleCrawlToggled(bool enabled)
+{
+    if (enabled) {
+        m_apiHandler->startPeriodicCrawl();
+        logMessage("Włączono cykliczną aktualizację wszystkich stacji");
+    } else {
+        m_apiHandler->stopPeriodicCrawl();
+        logMessage("Wyłączono cykliczną aktualizację wszystkich stacji");
+    }
+}
+
+void MainWindow::handleCrawlProgress(int completed, int total)
+{
+    ui->statusbar->showMessage(QString("Aktualizacja stacji: %1/%2").arg(completed).arg(total));
+}
+
+void MainWindow::handleCrawlFinished(int stations, int sensors, int failed)
+{
+    logMessage(QString("Zakończono aktualizację: %1 stacji, %2 czujników, błędy: %3")
+                   .arg(stations)
+                   .arg(sensors)
+                   .arg(failed));
+}
+
+void MainWindow::handleExceedanceReport()
+{
+    if (!m_currentMeasurement || m_currentView.isEmpty()) {
+        QMessageBox::information(this, "Raport przekroczeń",
+                                 "Brak godzinowych danych pomiarowych dla wyświetlanego zakresu.");
+        return;
+    }
+
+    const QString paramCode = m_currentMeasurement->paramCode();
+
+    //percentyle z ostatniego roku z dziennych szkiców - bez odczytu surowych pomiarów
+    const QDate today = QDate::currentDate();
+    const QuantileSketch sketch = databaseManager()->loadSketch({m_currentMeasurement->sensorId()},
+                                                                today.addYears(-1), today);
+    QString percentiles;
+    if (!sketch.isEmpty()) {
+        percentiles = QString("<br><br>Ostatnie 12 miesięcy (%1 pomiarów): P50 %2, P95 %3, P99 %4")
+                          .arg(sketch.count(), 0, 'f', 0)
+                          .arg(sketch.quantile(0.5), 0, 'f', 1)
+                          .arg(sketch.quantile(0.95), 0, 'f', 1)
+                          .arg(sketch.quantile(0.99), 0, 'f', 1);
+    }
+
+    const RollingAnalytics::ExceedanceReport report = RollingAnalytics::exceedances(m_currentView, paramCode);
+    if (!report.hasNorm) {
+        QMessageBox::information(this, "Raport przekroczeń",
+                                 QString("Dla parametru %1 nie ma normy krótkoterminowej.").arg(paramCode) + percentiles);
+        return;
+    }
+
+    QString text = QString("<b>%1</b><br>%2<br><br>Dni z wystarczającymi danymi: %3<br>"
+                           "Przekroczenia: <b>%4</b> (dopuszczalne w roku: %5)")
+                       .arg(paramCode, report.norm.description)
+                       .arg(report.coveredDays)
+                       .arg(report.exceedances)
+                       .arg(report.norm.allowedPerYear);
+    text += percentiles;
+
+    if (!report.days.isEmpty()) {
+        text += "<br><br><table border='1' cellpadding='3'>"
+                "<tr><th>Dzień</th><th>Średnia dobowa</th><th>Maks. 8h</th><th>Maks. 1h</th></tr>";
+        for (const auto& day : report.days) {
+            text += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td></tr>")
+                        .arg(day.date.toString("dd.MM.yyyy"))
+                        .arg(day.mean, 0, 'f', 1)
+                        .arg(day.max8hMean, 0, 'f', 1)
+                        .arg(day.max, 0, 'f', 1);
+        }
+        text += "</table>";
+    }
+
+    QMessageBox::information(this, "Raport przekroczeń", text);
+}
+
+void MainWindow::handleStationComparison()
+{
+    if (m_currentSensors.isEmpty()) {
+        QMessageBox::information(this, "Porównanie czujników", "Najpierw wybierz stację.");
+        return;
+    }
+
+    //ostatni tydzień każdego czujnika z bazy danych
+    const QDateTime to = QDateTime::currentDateTime();
+    const QDateTime from = to.addDays(-7);
+    QVector<Measurement> series;
+    series.reserve(m_currentSensors.size());
+    for (const Sensor& sensor : m_currentSensors) {
+        Measurement measurement(sensor.paramCode(), sensor.id());
+        measurement.merge(databaseManager()->loadMeasurements(sensor.id(), from, to));
+        if (measurement.validCount() > 0) {
+            series.append(measurement);
+        }
+    }
+
+    SeriesFrame frame = SeriesFrame::align(series);
+    if (frame.isEmpty()) {
+        QMessageBox::information(this, "Porównanie czujników",
+                                 "Brak zapisanych pomiarów czujników stacji z ostatnich 7 dni.");
+        return;
+    }
+    //macierz korelacji wszystkich par parametrów
+    const QVector<QVector<double>> correlations = frame.correlationMatrix();
+    QString text = "<b>Korelacja parametrów (ostatnie 7 dni)</b>"
+                   "<table border='1' cellpadding='5' width='100%' style='font-size:10pt'><tr><th></th>";
+    for (int c = 0; c < frame.columns(); ++c) {
+        text += QString("<th>%1</th>").arg(frame.label(c));
+    }
+    text += "</tr>";
+    for (int r = 0; r < frame.columns(); ++r) {
+        text += QString("<tr><th>%1</th>").arg(frame.label(r));
+        for (int c = 0; c < frame.columns(); ++c) {
+            const double value = correlations[r][c];
+            text += std::isnan(value) ? QString("<td>-</td>") : QString("<td>%1</td>").arg(value, 0, 'f', 2);
+        }
+        text += "</tr>";
+    }
+    text += "</table>";
+
+    //udział frakcji drobnej pyłu
+    const int pm25 = frame.indexOf("PM2.5");
+    const int pm10 = frame.indexOf("PM10");
+    if (pm25 >= 0 && pm10 >= 0) {
+        const QVector<float> ratio = frame.ratio(pm25, pm10);
+        double sum = 0;
+        int count = 0;
+        for (float value : ratio) {
+            if (!std::isnan(value)) {
+                sum += value;
+                ++count;
+            }
+        }
+        if (count > 0) {
+            text += QString("<br>Średni stosunek PM2.5/PM10: <b>%1</b> (%2 godzin)")
+                        .arg(sum / count, 0, 'f', 2)
+                        .arg(count);
+        }
+    }
+
+    //godziny tygodnia według poziomu indeksu jakości powietrza
+    const AirQualityCalculator::IndexHistory history =
+        AirQualityCalculator::history(m_currentSensors.first().stationId(), series);
+    int hoursPerLevel[AirQualityCalculator::MaxLevel + 1] = {};
+    for (qint8 level : history.levels) {
+        if (level != AirQualityCalculator::NoIndex) hoursPerLevel[level]++;
+    }
+    text += "<br><br><b>Indeks jakości powietrza (godziny)</b><br>";
+    for (int level = 0; level <= AirQualityCalculator::MaxLevel; ++level) {
+        if (hoursPerLevel[level] == 0) continue;
+        text += QString("%1: %2<br>").arg(AirQualityCalculator::indexLevel(level).name).arg(hoursPerLevel[level]);
+    }
+
+    ui->analysisBrowser->setHtml(text);
+
+    //statystyki liczone na surowych godzinach, pojedyncze luki uzupełniamy tylko dla wykresu
+    frame.interpolateGaps(2);
+    updateComparisonChart(frame);
 }
 
 
@@ -204,16 +411,19 @@ void MainWindow::handleMeasurementsFetched(const Measurement& measurement) {
     //zapisujemy nowe dane
     m_currentMeasurement = new Measurement(measurement);
 
-    //znajdujemy minimalne i maksymalne daty w otrzymanych danych
+    //seria jest uporządkowana od najnowszego, więc zakres dat to jej końce
+    const Measurement::View all = m_currentMeasurement->view();
     QDateTime minDate, maxDate;
-    bool first = true;
-    for (const auto& point : measurement.data()) {
-        if (first) {
-            minDate = maxDate = point.timestamp;
-            first = false;
-        } else {
-            if (point.timestamp < minDate) minDate = point.timestamp;
-            if (point.timestamp > maxDate) maxDate = point.timestamp;
+    for (int i = 0; i < all.size(); ++i) {
+        if (all.epochAt(i) != Measurement::InvalidTime) {
+            maxDate = all.timeAt(i);
+            break;
+        }
+    }
+    for (int i = all.size() - 1; i >= 0; --i) {
+        if (all.epochAt(i) != Measurement::InvalidTime) {
+            minDate = all.timeAt(i);
+            break;
         }
     }
 
@@ -224,12 +434,13 @@ void MainWindow::handleMeasurementsFetched(const Measurement& measurement) {
     }
 
     //aktualizujemy interfejs z pełnym zakresem danych
-    updateChart(measurement.data(), measurement.paramCode());
-    displayMeasurement(measurement); //pokazujemy wszystkie dane w tabeli
+    updateChart(all, m_currentMeasurement->paramCode());
+    displayMeasurement(*m_currentMeasurement); //pokazujemy wszystkie dane w tabeli
 
     //analiza danych
+    m_currentView = all;
     Measurement::AnalysisResult analysis = m_currentMeasurement->analyzeData();
-    displayAnalysis(analysis);
+    displayAnalysis(analysis, RollingAnalytics::summarize(all, m_currentMeasurement->paramCode()));
 
 }
 
@@ -281,10 +492,22 @@ void MainWindow::displayStations(const QVector<Station>& stations) {
     //sprawdzanie czy mamy współrzędne referencyjne (z geokodowania)
     bool hasReference = !std::isnan(m_referenceLat) && !std::isnan(m_referenceLon);
 
-    for (const auto& station : stations) {
+    //odległości wszystkich stacji jednym wywołaniem, lista od najbliższej
+    QVector<int> order(stations.size());
+    std::iota(order.begin(), order.end(), 0);
+    QVector<double> distances;
+    if (hasReference) {
+        distances = StationDistances(stations).distancesTo(m_referenceLat, m_referenceLon);
+        std::stable_sort(order.begin(), order.end(), [&distances](int a, int b) {
+            return distances[a] < distances[b];
+        });
+    }
+
+    for (int index : order) {
+        const Station& station = stations[index];
         QString text = station.toShortString();
         if (hasReference) {
-            text += " (" + station.distanceStringTo(m_referenceLat, m_referenceLon) + ")";
+            text += " (" + StationDistances::format(distances[index]) + ")";
         }
 
         QListWidgetItem *item = new QListWidgetItem(text);
@@ -296,6 +519,7 @@ void MainWindow::displayStations(const QVector<Station>& stations) {
 void MainWindow::displaySensors(const QVector<Sensor>& sensors) {
     qDebug() << "Wywołujemy displaySensors(), liczbę czujników: " << sensors.size();
 
+    m_currentSensors = sensors;
     ui->sensorList->clear();
     for (const auto& sensor : sensors) {
         QListWidgetItem *item = new QListWidgetItem(sensor.toString());
@@ -310,35 +534,8 @@ void MainWindow::displayMeasurement(const Measurement& measurement)
     table->clear();
     table->setColumnCount(3);
     table->setHorizontalHeaderLabels({"Czas", "Wartość", "Status"});
-    table->setRowCount(measurement.data().size());
-
-    int row = 0;
-    for (const auto& point : measurement.data()) {
-        //czas
-        QTableWidgetItem* timeItem = new QTableWidgetItem(point.timestamp.toString("yyyy-MM-dd HH:mm"));
-        timeItem->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-        table->setItem(row, 0, timeItem);
 
-        //wartość
-        QTableWidgetItem* valueItem = new QTableWidgetItem();
-        if (point.isValid && !std::isnan(point.value)) {
-            valueItem->setText(QString::number(point.value, 'f', 2));
-            valueItem->setTextAlignment(Qt::AlignCenter);
-            table->setItem(row, 1, valueItem);
-            table->setItem(row, 2, new QTableWidgetItem("OK"));
-        } else {
-            valueItem->setText("--");
-            valueItem->setTextAlignment(Qt::AlignCenter);
-            table->setItem(row, 1, valueItem);
-            table->setItem(row, 2, new QTableWidgetItem("Brak danych"));
-        }
-
-        //status
-        QTableWidgetItem* statusItem = table->item(row, 2);
-        statusItem->setTextAlignment(Qt::AlignCenter);
-
-        row++;
-    }
+    updateTableWithFilteredData(measurement.view());
 
     //dostosowanie wyglądu table
     table->resizeColumnsToContents();
@@ -401,6 +598,10 @@ void MainWindow::handleSearchNearby() {
 }
 
 void MainWindow::handleGeocodingResult(double lat, double lon) {
+    //punkt odniesienia dla odległości na liście stacji
+    m_referenceLat = lat;
+    m_referenceLon = lon;
+
     double radius = ui->radiusSpinBox->value();
     m_apiHandler->findStationsInRadius(lat, lon, radius);
 
@@ -429,12 +630,6 @@ void MainWindow::handleDateRangeApplied()
         return;
     }
 
-    if (dateFromEdit->date() < QDate::currentDate().addDays(-2)) {
-        QMessageBox::warning(this, "Błąd", "Możesz wybrać datę nie starszą niż 2 dni od dzisiejszej!");
-        dateFromEdit->setDate(QDate::currentDate().addDays(-2)); //autokorekta
-        return;
-    }
-
     //otrzymujemy tylko datę (bez godziny)
     QDate fromDate = dateFromEdit->date();
     QDate toDate = dateToEdit->date();
@@ -453,38 +648,136 @@ void MainWindow::handleDateRangeApplied()
     }
 
     if (m_currentMeasurement) {
-        QVector<Measurement::DataPoint> filtered = m_currentMeasurement->filterByDateRange(from, to);
+        //zakres sięgający przed wczytaną serię pochodzi z agregatów w bazie danych
+        const QVector<qint64> &times = m_currentMeasurement->times();
+        const bool hasOldest = !times.isEmpty() && times.last() != Measurement::InvalidTime;
+        if (!hasOldest || fromDate < QDateTime::fromSecsSinceEpoch(times.last()).date()) {
+            displayAggregatedRange(from, to);
+            return;
+        }
+
+        //widok na posortowaną serię - wyszukiwanie binarne bez kopiowania punktów
+        const Measurement::View filtered = m_currentMeasurement->range(from, to);
         updateChart(filtered, m_currentMeasurement->paramCode());
         updateTableWithFilteredData(filtered);
 
-        Measurement::AnalysisResult analysis = analyzeFilteredData(filtered);
-        displayAnalysis(analysis);
+        m_currentView = filtered;
+        Measurement::AnalysisResult analysis = Measurement::analyzeData(filtered);
+        displayAnalysis(analysis, RollingAnalytics::summarize(filtered, m_currentMeasurement->paramCode()));
     }
 }
 
-void MainWindow::updateTableWithFilteredData(const QVector<Measurement::DataPoint>& data) {
+void MainWindow::displayAggregatedRange(const QDateTime& from, const QDateTime& to)
+{
+    //liczba punktów wykresu nie zależy od długości historii
+    const int maxChartPoints = 200;
+    const QString paramCode = m_currentMeasurement->paramCode();
+    const int sensorId = m_currentMeasurement->sensorId();
+
+    AggregateTier tier = AggregateTier::Hour;
+    const QVector<MeasurementAggregate> buckets =
+        databaseManager()->loadAggregates(sensorId, from, to, from.secsTo(to) / maxChartPoints, &tier);
+
+    //seria średnich z przedziałów, od najnowszego jak w Measurement
+    m_aggregatedMeasurement = Measurement(paramCode, sensorId);
+    m_aggregatedMeasurement.reserve(buckets.size());
+    for (int i = buckets.size() - 1; i >= 0; --i) {
+        m_aggregatedMeasurement.appendPoint(buckets[i].start.toSecsSinceEpoch(), buckets[i].mean, true);
+    }
+
+    const Measurement::View view = m_aggregatedMeasurement.view();
+    updateChart(view, paramCode);
+    updateTableWithAggregates(buckets, tier);
+
+    Measurement::AnalysisResult analysis = Measurement::analyzeData(view);
+    RollingAnalytics::Summary rolling;
+    if (tier == AggregateTier::Hour) {
+        //surowe pomiary z bazy - pełna analiza okienkowa i raport przekroczeń
+        m_currentView = view;
+        rolling = RollingAnalytics::summarize(view, paramCode);
+    } else {
+        m_currentView = Measurement::View();
+
+        //skrajne wartości i średnia z agregatów, a nie ze średnich przedziałów
+        double sum = 0;
+        int count = 0;
+        for (const auto& bucket : buckets) {
+            if (bucket.min < analysis.minValue) {
+                analysis.minValue = bucket.min;
+                analysis.minTime = bucket.start;
+            }
+            if (bucket.max > analysis.maxValue) {
+                analysis.maxValue = bucket.max;
+                analysis.maxTime = bucket.start;
+            }
+            sum += bucket.mean * bucket.count;
+            count += bucket.count;
+        }
+        if (count > 0) analysis.avgValue = sum / count;
+    }
+    displayAnalysis(analysis, rolling);
+
+    ui->statusbar->showMessage(QString("Zakres z bazy danych: %1 przedziałów").arg(buckets.size()), 3000);
+}
+
+void MainWindow::updateTableWithAggregates(const QVector<MeasurementAggregate>& buckets, AggregateTier tier)
+{
+    const QString format = tier == AggregateTier::Hour ? "yyyy-MM-dd HH:mm"
+                           : tier == AggregateTier::Month ? "MM.yyyy"
+                                                          : "yyyy-MM-dd";
+    auto table = ui->measurementTable;
+    table->clearContents();
+    table->setRowCount(buckets.size());
+
+    //najnowsze na górze, jak dla surowych pomiarów
+    for (int row = 0; row < buckets.size(); ++row) {
+        const auto& bucket = buckets[buckets.size() - 1 - row];
+        table->setItem(row, 0, new QTableWidgetItem(bucket.start.toString(format)));
+
+        QTableWidgetItem* valueItem = new QTableWidgetItem(QString::number(bucket.mean, 'f', 2));
+        valueItem->setTextAlignment(Qt::AlignCenter);
+        table->setItem(row, 1, valueItem);
+
+        QTableWidgetItem* statusItem = new QTableWidgetItem(
+            tier == AggregateTier::Hour ? QString("OK")
+                                        : QString("%1 pomiarów (%2 - %3)")
+                                              .arg(bucket.count)
+                                              .arg(bucket.min, 0, 'f', 2)
+                                              .arg(bucket.max, 0, 'f', 2));
+        statusItem->setTextAlignment(Qt::AlignCenter);
+        table->setItem(row, 2, statusItem);
+    }
+}
+
+void MainWindow::updateTableWithFilteredData(const Measurement::View& data) {
     auto table = ui->measurementTable;
     table->clearContents();
     table->setRowCount(data.size());
 
     for (int row = 0; row < data.size(); ++row) {
-        const auto& point = data[row];
-        table->setItem(row, 0, new QTableWidgetItem(
-                                   point.timestamp.toString("yyyy-MM-dd HH:mm")));
+        const bool valid = data.isValidAt(row) && !std::isnan(data.valueAt(row));
+        QTableWidgetItem* timeItem = new QTableWidgetItem(data.timeAt(row).toString("yyyy-MM-dd HH:mm"));
+        timeItem->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+        table->setItem(row, 0, timeItem);
 
         QTableWidgetItem* valueItem = new QTableWidgetItem(
-            point.isValid ? QString::number(point.value, 'f', 2) : "--");
+            valid ? QString::number(data.valueAt(row), 'f', 2) : "--");
         valueItem->setTextAlignment(Qt::AlignCenter);
         table->setItem(row, 1, valueItem);
 
+        //flagi anomalii z detektora działającego przy pobieraniu danych
+        const quint8 flags = data.flagsAt(row);
         QTableWidgetItem* statusItem = new QTableWidgetItem(
-            point.isValid ? "OK" : "Brak danych");
+            !valid ? "Brak danych" : flags != AnomalyDetector::None ? AnomalyDetector::describe(flags) : "OK");
         statusItem->setTextAlignment(Qt::AlignCenter);
+        if (valid && flags != AnomalyDetector::None) {
+            statusItem->setBackground(QColor(255, 200, 120));
+        }
         table->setItem(row, 2, statusItem);
     }
 }
 
-void MainWindow::updateChart(const QVector<Measurement::DataPoint>& data, const QString& paramName)
+void MainWindow::updateChart(const Measurement::View& data, const QString& paramName)
 {
     qDebug() << "Aktualizacja wykresu za pomocą" << data.size() << "punktów danych";
 
@@ -513,33 +806,30 @@ void MainWindow::updateChart(const QVector<Measurement::DataPoint>& data, const
     series->setName(paramName);
     qDebug() << "Nazwa parametru:" << paramName;
 
-    // min i max daty i wartości
-    QDateTime minDate, maxDate;
+    // min i max daty i wartości (czasy jako liczby, QDateTime tylko dla osi)
+    qint64 minSecs = std::numeric_limits<qint64>::max();
+    qint64 maxSecs = std::numeric_limits<qint64>::min();
     double minVal = std::numeric_limits<double>::max();
     double maxVal = std::numeric_limits<double>::lowest();
     bool hasValidData = false;
 
-    for (const auto& point : data) {
-        if (point.isValid && !std::isnan(point.value)) {
-            qint64 msecs = point.timestamp.toMSecsSinceEpoch();
-            series->append(msecs, point.value);
+    //punkty dodajemy hurtowo, seria jest od najnowszego więc idziemy od końca
+    QList<QPointF> points;
+    points.reserve(data.size());
+    for (int i = data.size() - 1; i >= 0; --i) {
+        const qint64 secs = data.epochAt(i);
+        const double value = data.valueAt(i);
+        if (data.isValidAt(i) && !std::isnan(value) && secs != Measurement::InvalidTime) {
+            points.append(QPointF(secs * 1000.0, value));
             hasValidData = true;
 
-            // Update ranges
-            if (minDate.isNull() || point.timestamp < minDate) {
-                minDate = point.timestamp;
-            }
-            if (maxDate.isNull() || point.timestamp > maxDate) {
-                maxDate = point.timestamp;
-            }
-            if (point.value < minVal) {
-                minVal = point.value;
-            }
-            if (point.value > maxVal) {
-                maxVal = point.value;
-            }
+            minSecs = std::min(minSecs, secs);
+            maxSecs = std::max(maxSecs, secs);
+            minVal = std::min(minVal, value);
+            maxVal = std::max(maxVal, value);
         }
     }
+    series->replace(points);
 
     if (!hasValidData) {
         m_chart->setTitle("Brak ważnych danych");
@@ -555,6 +845,8 @@ void MainWindow::updateChart(const QVector<Measurement::DataPoint>& data, const
     m_axisX = new QDateTimeAxis();
     m_axisX->setFormat("dd.MM.yyyy HH:mm");
     m_axisX->setTitleText("Time");
+    const QDateTime minDate = QDateTime::fromSecsSinceEpoch(minSecs);
+    const QDateTime maxDate = QDateTime::fromSecsSinceEpoch(maxSecs);
     m_axisX->setRange(minDate, maxDate);
 
     //konfiguracja osi Y (wartości)
@@ -578,6 +870,124 @@ void MainWindow::updateChart(const QVector<Measurement::DataPoint>& data, const
     qDebug() << "Aktualizacja wykresu zakończona. Zakres czasu:" << minDate << "-" << maxDate;
 }
 
+void MainWindow::handlePollutionMap()
+{
+    if (m_allStations.isEmpty()) {
+        QMessageBox::information(this, "Mapa zanieczyszczeń", "Lista stacji nie została jeszcze wczytana.");
+        return;
+    }
+
+    bool ok = false;
+    const QString paramCode = QInputDialog::getItem(this, "Mapa zanieczyszczeń", "Parametr:",
+                                                    {"PM10", "PM2.5", "NO2", "O3", "SO2"}, 0, false, &ok);
+    if (!ok) return;
+    const QStringList methods = {"Odwrotne odległości (IDW)", "Kriging zwykły"};
+    const QString method = QInputDialog::getItem(this, "Mapa zanieczyszczeń", "Metoda interpolacji:",
+                                                 methods, 0, false, &ok);
+    if (!ok) return;
+
+    //najnowsza wartość parametru na każdej stacji z ostatnich godzin (serie są od najnowszego)
+    const QDateTime from = QDateTime::currentDateTime().addSecs(-3 * 3600);
+    const QHash<int, QVector<Measurement>> series = databaseManager()->loadStationSeries({}, from, QDateTime());
+    QVector<double> values(m_allStations.size(), NAN);
+    int measured = 0;
+    for (int i = 0; i < m_allStations.size(); ++i) {
+        for (const Measurement& measurement : series.value(m_allStations[i].id())) {
+            if (measurement.paramCode().compare(paramCode, Qt::CaseInsensitive) == 0 && !measurement.isEmpty()) {
+                values[i] = measurement.values().first();
+                ++measured;
+                break;
+            }
+        }
+    }
+    if (measured == 0) {
+        QMessageBox::information(this, "Mapa zanieczyszczeń",
+                                 QString("Brak zapisanych pomiarów %1 z ostatnich 3 godzin.").arg(paramCode));
+        return;
+    }
+
+    PollutionHeatmap::Options options;
+    options.method = method == methods.last() ? PollutionHeatmap::Method::OrdinaryKriging
+                                              : PollutionHeatmap::Method::InverseDistance;
+    QElapsedTimer timer;
+    timer.start();
+    const PollutionHeatmap::Raster raster = PollutionHeatmap::generate(m_allStations, values, options);
+    logMessage(QString("Mapa %1: %2 stacji, %3x%4 komórek w %5 ms")
+                   .arg(paramCode)
+                   .arg(measured)
+                   .arg(raster.cols)
+                   .arg(raster.rows)
+                   .arg(timer.elapsed()));
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(QString("Mapa zanieczyszczeń - %1").arg(paramCode));
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    QLabel *map = new QLabel(dialog);
+    //komórki mają równe boki w stopniach - szerokość skalowana do proporcji w km na środku Polski
+    map->setPixmap(QPixmap::fromImage(PollutionHeatmap::toImage(raster, paramCode)
+                                          .scaled(int(raster.cols * 4 * std::cos(qDegreesToRadians(52.0))),
+                                                  raster.rows * 4, Qt::IgnoreAspectRatio,
+                                                  Qt::SmoothTransformation)));
+    layout->addWidget(map);
+    layout->addWidget(new QLabel(QString("%1, stacje z pomiarem: %2. Kolory według progów indeksu jakości powietrza.")
+                                     .arg(method)
+                                     .arg(measured), dialog));
+    dialog->show();
+}
+
+void MainWindow::updateComparisonChart(const SeriesFrame& frame)
+{
+    if (m_axisX) {
+        m_chart->removeAxis(m_axisX);
+        delete m_axisX;
+        m_axisX = nullptr;
+    }
+    if (m_axisY) {
+        m_chart->removeAxis(m_axisY);
+        delete m_axisY;
+        m_axisY = nullptr;
+    }
+    m_chart->removeAllSeries();
+
+    m_axisX = new QDateTimeAxis();
+    m_axisX->setFormat("dd.MM.yyyy HH:mm");
+    m_axisX->setTitleText("Time");
+    m_axisX->setRange(QDateTime::fromSecsSinceEpoch(frame.timeAt(0)),
+                      QDateTime::fromSecsSinceEpoch(frame.timeAt(frame.rows() - 1)));
+    m_axisY = new QValueAxis();
+    m_axisY->setTitleText("µg/m³");
+    m_chart->addAxis(m_axisX, Qt::AlignBottom);
+    m_chart->addAxis(m_axisY, Qt::AlignLeft);
+
+    //wspólna siatka godzinowa - jedna seria na kolumnę, luki dzielą linię
+    double minVal = std::numeric_limits<double>::max();
+    double maxVal = std::numeric_limits<double>::lowest();
+    for (int c = 0; c < frame.columns(); ++c) {
+        const QVector<float>& column = frame.column(c);
+        QList<QPointF> points;
+        points.reserve(frame.rows());
+        for (int row = 0; row < frame.rows(); ++row) {
+            if (std::isnan(column[row])) continue;
+            points.append(QPointF(frame.timeAt(row) * 1000.0, column[row]));
+            minVal = std::min(minVal, double(column[row]));
+            maxVal = std::max(maxVal, double(column[row]));
+        }
+
+        QLineSeries *series = new QLineSeries();
+        series->setName(frame.label(c));
+        series->replace(points);
+        m_chart->addSeries(series);
+        series->attachAxis(m_axisX);
+        series->attachAxis(m_axisY);
+    }
+
+    const double padding = (maxVal - minVal) * 0.1;
+    m_axisY->setRange(minVal - padding, maxVal + padding);
+    m_chart->setTitle("Porównanie czujników stacji");
+    ui->chartsBrowser->repaint();
+}
+
 DatabaseManager* MainWindow::databaseManager() const {
     return m_apiHandler->databaseManager();
 }
@@ -622,101 +1032,48 @@ void MainWindow::showEvent(QShowEvent *event) {
     }
 }
 
-void MainWindow::displayAnalysis(const Measurement::AnalysisResult& analysis)
+void MainWindow::displayAnalysis(const Measurement::AnalysisResult& analysis, const RollingAnalytics::Summary& rolling)
 {
     QString analysisText = QStringLiteral(
                                "<table border='1' cellpadding='5' width='100%' style='font-size:10pt'>"
                                "<tr><td>Wartość minimalna:</td><td>%1</td><td>%2</td></tr>"
                                "<tr><td>Wartość maksymalna:</td><td>%3</td><td>%4</td></tr>"
                                "<tr><td>Średnia wartość:</td><td colspan='2'>%5</td></tr>"
-                               "<tr><td>Trend:</td><td colspan='2' style='color:%6'><b>%7</b></td></tr>"
+                               "<tr><td>Odchylenie standardowe:</td><td colspan='2'>%6</td></tr>"
+                               "<tr><td>Trend:</td><td colspan='2' style='color:%7'><b>%8</b></td></tr>"
                                "</table>")
                                .arg(analysis.minValue, 0, 'f', 2)
                                .arg(analysis.minTime.toString("dd.MM.yyyy HH:mm"))
                                .arg(analysis.maxValue, 0, 'f', 2)
                                .arg(analysis.maxTime.toString("dd.MM.yyyy HH:mm"))
                                .arg(analysis.avgValue, 0, 'f', 2)
+                               .arg(analysis.stdDev, 0, 'f', 2)
                                .arg(analysis.trendValue >= 0 ? "red" : "green")
                                .arg(analysis.trend);
 
-    ui->analysisBrowser->setHtml(analysisText);
-}
-
-Measurement::AnalysisResult MainWindow::analyzeFilteredData(const QVector<Measurement::DataPoint>& filteredData)
-{
-    Measurement::AnalysisResult result;
-    result.minValue = std::numeric_limits<double>::max();
-    result.maxValue = std::numeric_limits<double>::lowest();
-    result.avgValue = 0;
-    result.trend = "Za mało danych";
-    result.trendValue = 0;
-
-    if(filteredData.size() < 2) {
-        return result; //niewystarczające dane do analizy trendu
-    }
-
-    //obliczenie min, max i średnią
-    double sum = 0;
-    int validPoints = 0;
-
-    for(const auto& point : filteredData) {
-        if(point.isValid && !std::isnan(point.value)) {
-            //aktualizacja min i max
-            if(point.value < result.minValue) {
-                result.minValue = point.value;
-                result.minTime = point.timestamp;
-            }
-            if(point.value > result.maxValue) {
-                result.maxValue = point.value;
-                result.maxTime = point.timestamp;
-            }
-            sum += point.value;
-            validPoints++;
-        }
+    //średnie kroczące i przekroczenia norm (tylko dla surowych pomiarów)
+    if (!rolling.lastDay.date.isValid()) {
+        ui->analysisBrowser->setHtml(analysisText);
+        return;
     }
-
-    //obliczamy średnią
-    result.avgValue = validPoints > 0 ? sum / validPoints : NAN;
-
-    //obliczamy trend (regresja liniowa)
-    if(validPoints >= 2) {
-        double sumX = 0, sumY = 0, sumXY = 0, sumX2 = 0;
-        int n = 0;
-
-        for(const auto& point : filteredData) {
-            if(point.isValid && !std::isnan(point.value)) {
-                double x = point.timestamp.toSecsSinceEpoch() / 3600.0;
-                double y = point.value;
-                sumX += x;
-                sumY += y;
-                sumXY += x * y;
-                sumX2 += x * x;
-                n++;
-            }
-        }
-
-        if(n > 1) {
-            double denominator = n * sumX2 - sumX * sumX;
-            if(denominator != 0) {
-                double a = (n * sumXY - sumX * sumY) / denominator;
-                result.trendValue = a;
-
-                if(abs(a) < 0.01) {
-                    result.trend = "<span style='color:black;'>Stabilne</span>";
-                }
-                else if(a > 0) {
-                    result.trend = QString("<span style='color:green;'>Wzrost (%1/h)</span>")
-                    .arg(a, 0, 'f', 3);
-                }
-                else {
-                    result.trend = QString("<span style='color:red;'>Spadek (%1/h)</span>")
-                    .arg(a, 0, 'f', 3);
-                }
-            }
-        }
+    analysisText += QStringLiteral(
+                        "<table border='1' cellpadding='5' width='100%' style='font-size:10pt'>"
+                        "<tr><td>Średnia 1h / 8h / 24h:</td><td>%1 / %2 / %3</td></tr>"
+                        "<tr><td>Średnia dobowa (%4):</td><td>%5</td></tr>")
+                        .arg(rolling.latest1h, 0, 'f', 2)
+                        .arg(rolling.latest8h, 0, 'f', 2)
+                        .arg(rolling.latest24h, 0, 'f', 2)
+                        .arg(rolling.lastDay.date.toString("dd.MM.yyyy"))
+                        .arg(rolling.lastDay.mean, 0, 'f', 2);
+    if (rolling.exceedance.hasNorm) {
+        analysisText += QString("<tr><td>Przekroczenia normy:</td><td>%1 (dni z danymi: %2, dopuszczalne %3 w roku)</td></tr>")
+                            .arg(rolling.exceedance.exceedances)
+                            .arg(rolling.exceedance.coveredDays)
+                            .arg(rolling.exceedance.norm.allowedPerYear);
     }
+    analysisText += "</table>";
 
-    return result;
+    ui->analysisBrowser->setHtml(analysisText);
 }
 
 void MainWindow::initializeStations()
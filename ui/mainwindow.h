@@ -20,6 +20,8 @@
 #include <QDateEdit>
 #include <QLabel>
 #include "jsonbasemanager.h"
+#include "RollingAnalytics.h"
+#include "SeriesFrame.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -101,6 +103,12 @@ private slots:
      */
     void handleFilterClicked();
 
+    /**
+     * @brief Slot wyświetlający stacje pasujące do wpisywanego tekstu
+     * @param query Fragment nazwy stacji, miasta lub ulicy
+     */
+    void applyStationFilter(const QString& query);
+
     /**
      * @brief Slot obsługujący wyszukiwanie stacji w pobliżu
      */
@@ -129,15 +137,55 @@ private slots:
      */
     void initializeStations();
 
+    /**
+     * @brief Slot obsługujący przełączenie cyklicznej aktualizacji wszystkich stacji
+     * @param enabled true aby włączyć aktualizację
+     */
+    void handleCrawlToggled(bool enabled);
+
+    /**
+     * @brief Slot obsługujący postęp pełnej aktualizacji
+     * @param completed Liczba zakończonych zadań
+     * @param total Liczba znanych zadań
+     */
+    void handleCrawlProgress(int completed, int total);
+
+    /**
+     * @brief Slot obsługujący zakończenie pełnej aktualizacji
+     * @param stations Liczba stacji
+     * @param sensors Liczba czujników
+     * @param failed Liczba nieudanych zadań
+     */
+    void handleCrawlFinished(int stations, int sensors, int failed);
+
+    /**
+     * @brief Slot wyświetlający raport przekroczeń norm dla wyświetlanego zakresu
+     */
+    void handleExceedanceReport();
+
+    /**
+     * @brief Slot porównujący wszystkie czujniki wybranej stacji na wspólnej osi czasu
+     */
+    void handleStationComparison();
+
+    /**
+     * @brief Slot generujący mapę stężeń zanieczyszczenia nad Polską z ostatnich pomiarów stacji
+     */
+    void handlePollutionMap();
+
 private:
     Ui::MainWindow *ui;                          /**< Wskaźnik na interfejs użytkownika */
     ApiHandler *m_apiHandler;                    /**< Wskaźnik na obiekt obsługi API */
     QVector<Station> m_allStations;              /**< Lista wszystkich stacji */
+    QVector<Sensor> m_currentSensors;            /**< Czujniki wybranej stacji */
     double m_referenceLat = NAN;                 /**< Referencyjna szerokość geograficzna */
     double m_referenceLon = NAN;                 /**< Referencyjna długość geograficzna */
     QChart *m_chart;                             /**< Wskaźnik na obiekt wykresu */
     QChartView *m_chartView;                     /**< Wskaźnik na widok wykresu */
     Measurement* m_currentMeasurement = nullptr; /**< Aktualne pomiary */
+    RequestHandle m_measurementsRequest; /**< Uchwyt trwającego pobierania pomiarów */
+    Measurement::View m_currentView;             /**< Wyświetlany zakres aktualnych pomiarów */
+    Measurement m_aggregatedMeasurement;         /**< Średnie z agregatów bazy dla długich zakresów */
     QDateEdit* dateFromEdit;                     /**< Widget edycji daty początkowej */
     QDateEdit* dateToEdit;                       /**< Widget edycji daty końcowej */
     QDateTimeAxis *m_axisX = nullptr;            /**< Oś X wykresu (czas) */
@@ -177,16 +225,36 @@ private:
 
     /**
      * @brief Aktualizuje wykres
-     * @param data Dane do wyświetlenia na wykresie
+     * @param data Widok na dane do wyświetlenia na wykresie
      * @param paramName Nazwa parametru
      */
-    void updateChart(const QVector<Measurement::DataPoint>& data, const QString& paramName);
+    void updateChart(const Measurement::View& data, const QString& paramName);
 
     /**
      * @brief Aktualizuje tabelę z przefiltrowanymi danymi
-     * @param data Przefiltrowane dane do wyświetlenia
+     * @param data Widok na przefiltrowane dane do wyświetlenia
+     */
+    void updateTableWithFilteredData(const Measurement::View& data);
+
+    /**
+     * @brief Wyświetla zakres spoza wczytanej serii na podstawie agregatów z bazy danych
+     * @param from Data początkowa zakresu
+     * @param to Data końcowa zakresu
+     */
+    void displayAggregatedRange(const QDateTime& from, const QDateTime& to);
+
+    /**
+     * @brief Aktualizuje tabelę agregatami pomiarów
+     * @param buckets Agregaty od najstarszego
+     * @param tier Poziom agregacji
+     */
+    void updateTableWithAggregates(const QVector<MeasurementAggregate>& buckets, AggregateTier tier);
+
+    /**
+     * @brief Wyświetla na wykresie wszystkie kolumny ramki wyrównanych serii
+     * @param frame Serie wyrównane do wspólnej siatki godzinowej
      */
-    void updateTableWithFilteredData(const QVector<Measurement::DataPoint>& data);
+    void updateComparisonChart(const SeriesFrame& frame);
 
     /**
      * @brief Sprawdza połączenie z internetem
@@ -203,15 +271,9 @@ private:
     /**
      * @brief Wyświetla analizę danych
      * @param analysis Wyniki analizy
+     * @param rolling Średnie kroczące i przekroczenia norm
      */
-    void displayAnalysis(const Measurement::AnalysisResult& analysis);
-
-    /**
-     * @brief Analizuje przefiltrowane dane
-     * @param filteredData Dane do analizy
-     * @return Wyniki analizy
-     */
-    Measurement::AnalysisResult analyzeFilteredData(const QVector<Measurement::DataPoint>& filteredData);
+    void displayAnalysis(const Measurement::AnalysisResult& analysis, const RollingAnalytics::Summary& rolling);
 
     /**
      * @brief Zwraca wskaźnik na menedżera bazy danych